@@ -2,6 +2,7 @@
 #include "ui_AuthWidget.h"
 
 #include <QtCore/QSettings>
+#include <QtCore/QUrl>
 
 AuthWidget::AuthWidget (QWidget *parent)
     : QWidget (parent)
@@ -14,20 +15,42 @@ AuthWidget::AuthWidget (QWidget *parent)
     connect (ui->_editRedmineUrl, &QLineEdit::textChanged, this, &AuthWidget::slotUpdateLoginButton);
     connect (ui->_buttonLogin, &QPushButton::clicked, this, &AuthWidget::slotLoginClicked);
 
+    // Connect to the server while the user is still typing, but not for every keystroke
+    _preconnectTimer = new QTimer (this);
+    _preconnectTimer->setSingleShot (true);
+    _preconnectTimer->setInterval (500);
+    connect (_preconnectTimer, &QTimer::timeout, this, &AuthWidget::slotPreconnect);
+    connect (ui->_editRedmineUrl, &QLineEdit::textEdited, this, [this]() { _preconnectTimer->start (); });
+
     QSettings settings;
     ui->_checkRemember->setChecked (settings.value ("redmine connection/remember").toBool ());
     if (ui->_checkRemember->isChecked ()) {
         ui->_editUser->setText (settings.value ("redmine connection/user", "").toString ());
         ui->_editPassword->setText (settings.value ("redmine connection/password", "").toString ());
         ui->_editRedmineUrl->setText (settings.value ("redmine connection/url", "").toString ());
+
+        // The data of the last session can be shown before Redmine has been reached
+        openStore ();
+        slotPreconnect ();
     }
 }
 
 AuthWidget::~AuthWidget ()
 {
+    _request.cancel ();
+
+    // A confirmed project list has been handed over to the next screen
+    if (!_prefetchedProjects.isConfirmed ())
+        _prefetchedProjects.discard ();
+
     delete ui;
 }
 
+Speculation<Projects> AuthWidget::prefetchedProjects () const
+{
+    return _prefetchedProjects;
+}
+
 void AuthWidget::slotUpdateLoginButton ()
 {
     if (ui->_editUser->text ().isEmpty () ||
@@ -39,17 +62,69 @@ void AuthWidget::slotUpdateLoginButton ()
     }
 }
 
+void AuthWidget::setupClient ()
+{
+    QSettings settings;
+
+    if (!SimpleRedmineClient::_instance) {
+        new SimpleRedmineClient ();
+        if (settings.value ("redmine connection/network thread", false).toBool ())
+            SimpleRedmineClient::_instance->setThreadMode (ThreadMode::NetworkThread);
+    }
+
+    // The pre-connection has to use the same SSL check and protocols as the requests
+    SimpleRedmineClient::_instance->setCheckSsl (settings.value ("redmine connection/check ssl", true).toBool ());
+    SimpleRedmineClient::_instance->setTransportMode (settings.value ("redmine connection/multiplexed", false).toBool ()
+                                                      ? TransportMode::Multiplexed : TransportMode::Standard);
+    SimpleRedmineClient::_instance->setDecoder (settings.value ("redmine connection/fast decoder", false).toBool ()
+                                                ? DecoderBackend::Fast : DecoderBackend::Document);
+}
+
+void AuthWidget::openStore ()
+{
+    // Keep the data of this server and user across restarts
+    QString fileName = LocalStore::defaultFileName (ui->_editRedmineUrl->text (), ui->_editUser->text ());
+
+    // The store belongs to the main dialog
+    if (!LocalStore::_instance)
+        return;
+    if (LocalStore::_instance->fileName () != fileName)
+        LocalStore::_instance->open (fileName);
+}
+
+void AuthWidget::slotPreconnect ()
+{
+    // Partially typed URLs must not reach the network
+    QUrl url (ui->_editRedmineUrl->text (), QUrl::StrictMode);
+    if (!url.isValid () || url.host ().isEmpty () || (url.scheme () != "http" && url.scheme () != "https"))
+        return;
+
+    // The URL itself is only set on login, as it also selects the disk cache
+    setupClient ();
+    SimpleRedmineClient::_instance->preconnect (url.toString ());
+}
+
 void AuthWidget::slotLoginClicked ()
 {
-    if (!SimpleRedmineClient::_instance)
-        new SimpleRedmineClient (ui->_editRedmineUrl->text ());
+    _preconnectTimer->stop ();
+
+    setupClient ();
 
+    SimpleRedmineClient::_instance->setUrl (ui->_editRedmineUrl->text ());
     SimpleRedmineClient::_instance->setAuthenticator (ui->_editUser->text (), ui->_editPassword->text ());
-    SimpleRedmineClient::_instance->retrieveCurrentUser
+    _request.cancel ();
+
+    // Fetch the first screen's data while the login is checked; it is dropped if the login fails
+    _prefetchedProjects.discard ();
+    _prefetchedProjects.setRequest (SimpleRedmineClient::_instance->retrieveProjects
+            (_prefetchedProjects.callback (), RedmineOptions ("", true, 4)));
+
+    _request = SimpleRedmineClient::_instance->retrieveCurrentUser
             ([this]( User /*user*/, RedmineError redmineError, const QStringList &errors)
     {
         if (redmineError != RedmineError::NO_ERR) {
             qCritical () << "[AuthWidget][slotLoginClicked]" << errors;
+            _prefetchedProjects.discard ();
             return;
         }
 
@@ -65,6 +140,9 @@ void AuthWidget::slotLoginClicked ()
             settings.setValue ("redmine connection/url", "");
         }
 
+        openStore ();
+
+        _prefetchedProjects.confirm ();
         emit loginSuccess ();
     } );
 }
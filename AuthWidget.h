@@ -1,8 +1,11 @@
 #ifndef AUTHWIDGET_H
 #define AUTHWIDGET_H
 
+#include "qtredmine/LocalStore.h"
 #include "qtredmine/SimpleRedmineClient.h"
+#include "qtredmine/Speculation.h"
 using namespace qtredmine;
+#include <QtCore/QTimer>
 #include <QtWidgets/QWidget>
 
 namespace Ui {
@@ -17,15 +20,28 @@ public:
     explicit AuthWidget (QWidget *parent = nullptr);
     virtual ~AuthWidget();
 
+    //! @brief Get the project list fetched while the login was checked
+    Speculation<Projects> prefetchedProjects () const;
+
 signals:
     void loginSuccess ();
 
 protected slots:
     void slotUpdateLoginButton ();
     void slotLoginClicked ();
+    void slotPreconnect ();
 
 private:
+    //! @brief Create the client if needed and apply the connection settings
+    void setupClient ();
+
+    //! @brief Open the local store of the entered server and user, unless it is already open
+    void openStore ();
+
     Ui::AuthWidget *ui {nullptr};
+    QTimer *_preconnectTimer {nullptr};
+    RequestHandle _request;
+    Speculation<Projects> _prefetchedProjects;
 };
 
 #endif // AUTHWIDGET_H
@@ -1,7 +1,9 @@
 #include "IssuesWidget.h"
 #include "ui_IssuesWidget.h"
+#include <QtCore/QSharedPointer>
 #include <QtCore/QTimer>
 
+#include "qtredmine/LocalStore.h"
 #include "qtredmine/SimpleRedmineClient.h"
 using namespace qtredmine;
 
@@ -16,25 +18,54 @@ IssuesWidget::IssuesWidget (int id, QWidget *parent)
 
 IssuesWidget::~IssuesWidget ()
 {
+    // Also stops fetching the remaining pages
+    _request.cancel ();
     delete ui;
 }
 
 void IssuesWidget::slotReload ()
 {
-    SimpleRedmineClient::_instance->retrieveIssues
-            ([this](Issues issues, RedmineError redmineError, const QStringList &errors)
+    _request.cancel ();
+
+    // The last known issues are shown until the current ones arrive, or if Redmine is not accessible
+    // The snapshot is read in place; the database is only queried once it is out of date
+    if (LocalStore::_instance && LocalStore::_instance->isSnapshotCurrent ()) {
+        const Snapshot &snapshot = LocalStore::_instance->snapshot ();
+        for (int row = 0; row < snapshot.issueCount (); ++row) {
+            IssueView issue = snapshot.issue (row);
+            if (issue.projectId () == _id)
+                qDebug () << issue.subject ();
+        }
+    }
+    else if (LocalStore::_instance) {
+        LocalStore::IssueFilter filter;
+        filter.projectId = _id;
+        for (const Issue &issue : LocalStore::_instance->issues (filter))
+            qDebug () << issue.subject;
+    }
+
+    // Kept for the snapshot, which is only updated once all pages have arrived
+    QSharedPointer<Issues> synced (new Issues ());
+
+    // The server only returns the issues of the project itself, without its subprojects
+    _request = SimpleRedmineClient::_instance->streamIssues
+            ([synced](Issues issues, int /*offset*/, int /*totalCount*/)
+    {
+        if (LocalStore::_instance)
+            LocalStore::_instance->storeIssues (issues);
+        *synced += issues;
+
+        for (const Issue &issue : issues)
+            qDebug () << issue.subject;
+    },
+    [synced](int /*count*/, int /*totalCount*/, RedmineError redmineError, const QStringList &errors)
     {
         if (redmineError != RedmineError::NO_ERR) {
             qDebug () << errors;
             return;
         }
 
-        for (const Issue &issue : issues)
-        {
-            if (issue.project._id != _id)
-                continue;
-            else
-                qDebug () << issue.subject;
-        }
-    } );
+        if (LocalStore::_instance)
+            LocalStore::_instance->updateSnapshot (*synced);
+    }, RedmineOptions (RedmineQuery ().project (_id).set ("subproject_id", "!*"), true, 4) );
 }
@@ -2,6 +2,7 @@
 #define ISSUEWIDGET_H
 
 #include <QtWidgets/QWidget>
+#include "qtredmine/RequestHandle.h"
 
 namespace Ui {
     class IssuesWidget;
@@ -21,6 +22,7 @@ protected slots:
 private:
     Ui::IssuesWidget *ui {nullptr};
     int _id {-1};
+    qtredmine::RequestHandle _request;
 };
 
 #endif // ISSUEWIDGET_H
@@ -2,34 +2,60 @@
 #include "ui_MainDialog.h"
 
 #include <QtCore/QDebug>
-#include <QtWidgets/QHBoxLayout>
+#include <QtWidgets/QVBoxLayout>
 
 MainDialog::MainDialog (QWidget *parent)
     : QDialog (parent)
 {
     resize (400, 640);
 
-    QHBoxLayout *ml = new QHBoxLayout ();
+    QVBoxLayout *ml = new QVBoxLayout ();
     ml->setContentsMargins (0, 0, 0, 0);
     setLayout (ml);
 
+    // Opened by the login form; closed, after its snapshot updates, when the dialog is destroyed at exit
+    _localStore = new LocalStore ();
+
     _authWidget = new AuthWidget (this);
     connect (_authWidget, &AuthWidget::loginSuccess, this, [this]()
     {
+        Speculation<Projects> projects = _authWidget->prefetchedProjects ();
         delete _authWidget;
         _authWidget = nullptr;
 
-        _projectsWidget = new ProjectListWidget (this);
+        // The stored projects shown before the login are replaced by the list that fetches them
+        delete _projectsWidget;
+        _projectsWidget = nullptr;
+
+        SimpleRedmineClient::_instance->setLocalStore (LocalStore::_instance);
+
+        // Warm up the reference data while the project list loads
+        _referenceData = new ReferenceData (SimpleRedmineClient::_instance, this);
+        _referenceData->setLocalStore (LocalStore::_instance);
+        _referenceData->bootstrap (RequestPriority::Prefetch);
+
+        _projectsWidget = new ProjectListWidget (projects, this);
         connect (_projectsWidget, &ProjectListWidget::signalSelected,
                  this, &MainDialog::slotProjectSelected);
         layout ()->addWidget (_projectsWidget);
 
     });
     ml->addWidget (_authWidget);
+
+    // The remembered server's projects are shown while logging in; issues can be opened after it
+    if (LocalStore::_instance && LocalStore::_instance->isOpen ()) {
+        _projectsWidget = new ProjectListWidget (this);
+        ml->addWidget (_projectsWidget);
+    }
 }
 
 MainDialog::~MainDialog()
 {
+    // Nothing must be stored once the store is gone
+    if (SimpleRedmineClient::_instance)
+        SimpleRedmineClient::_instance->setLocalStore (nullptr);
+    delete _referenceData;
+    delete _localStore;
     //delete ui;
 }
 
@@ -5,6 +5,7 @@
 #include "AuthWidget.h"
 #include "ProjectListWidget.h"
 #include "IssuesWidget.h"
+#include "qtredmine/ReferenceData.h"
 
 class MainDialog : public QDialog
 {
@@ -21,5 +22,7 @@ private:
     AuthWidget *_authWidget {nullptr};
     ProjectListWidget *_projectsWidget {nullptr};
     IssuesWidget *_issuesWidget {nullptr};
+    ReferenceData *_referenceData {nullptr};
+    LocalStore *_localStore {nullptr};
 };
 #endif // MAINDIALOG_H
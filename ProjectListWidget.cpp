@@ -3,12 +3,14 @@
 
 #include <QtCore/QTimer>
 
+#include "qtredmine/LocalStore.h"
 #include "qtredmine/SimpleRedmineClient.h"
 using namespace qtredmine;
 
-ProjectListWidget::ProjectListWidget (QWidget *parent)
+ProjectListWidget::ProjectListWidget (const Speculation<Projects> &prefetched, QWidget *parent)
     : QWidget (parent)
     , ui (new Ui::ProjectListWidget)
+    , _prefetched (prefetched)
 {
     ui->setupUi (this);
     _w = new WidgetScroll (this);
@@ -20,8 +22,17 @@ ProjectListWidget::ProjectListWidget (QWidget *parent)
     QTimer::singleShot (0, this, &ProjectListWidget::slotReload);
 }
 
+ProjectListWidget::ProjectListWidget (QWidget *parent)
+    : ProjectListWidget (Speculation<Projects> (), parent)
+{
+    _fetch = false;
+}
+
 ProjectListWidget::~ProjectListWidget ()
 {
+    // The callback must not run into a deleted widget
+    _request.cancel ();
+    _prefetched.discard ();
     delete ui;
 }
 
@@ -29,19 +40,47 @@ void ProjectListWidget::slotReload ()
 {
     _w->removeAllProjectWidgets ();
 
-    SimpleRedmineClient::_instance->retrieveProjects ([this]( Projects projects, RedmineError redmineError, QStringList errors)
+    // The last known projects are shown until the current ones arrive, or if Redmine is not accessible
+    if (LocalStore::_instance)
+        showProjects (LocalStore::_instance->projects ());
+
+    if (!_fetch)
+        return;
+
+    auto cb = [this]( Projects projects, RedmineError redmineError, QStringList errors)
     {
         if (redmineError != RedmineError::NO_ERR) {
             qDebug () << errors;
             return;
         }
 
-        for (const auto& project : projects) {
-            auto wid = new ProjectWidget (project, this);
-            connect (wid, &ProjectWidget::signalSelected, this, &ProjectListWidget::signalSelected);
-            _w->addProjectWidget (wid);
+        if (LocalStore::_instance) {
+            LocalStore::_instance->storeProjects (projects, true);
+            LocalStore::_instance->updateSnapshot (Issues (), projects, true);
         }
-    } );
+
+        _w->removeAllProjectWidgets ();
+        showProjects (projects);
+    };
+
+    // The first load uses the projects fetched during the login, reloads fetch them again
+    _request.cancel ();
+    if (_prefetched.take (cb))
+        return;
+
+    _prefetched.discard ();
+    _request = SimpleRedmineClient::_instance->retrieveProjects (cb, RedmineOptions ("", true, 4) );
+}
+
+void ProjectListWidget::showProjects (const Projects &projects)
+{
+    for (const auto& project : projects) {
+        auto wid = new ProjectWidget (project, this);
+        connect (wid, &ProjectWidget::signalSelected, this, &ProjectListWidget::signalSelected);
+        _w->addProjectWidget (wid);
+    }
+
+    _w->slotFiltered (ui->_editFilter->text ());
 }
 
 //-----------------------------------------------------------------
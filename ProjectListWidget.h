@@ -4,6 +4,8 @@
 #include <QtWidgets/QWidget>
 #include <QtWidgets/QVBoxLayout>
 #include "ProjectWidget.h"
+#include "qtredmine/RequestHandle.h"
+#include "qtredmine/Speculation.h"
 
 namespace Ui {
     class ProjectListWidget;
@@ -37,6 +39,10 @@ class ProjectListWidget : public QWidget
     Q_OBJECT
 
 public:
+    explicit ProjectListWidget (const qtredmine::Speculation<qtredmine::Projects> &prefetched,
+                                QWidget *parent = nullptr);
+
+    //! @brief Constructor for a list of the stored projects only, e.g. before the login
     explicit ProjectListWidget (QWidget *parent = nullptr);
     virtual ~ProjectListWidget ();
 
@@ -47,8 +53,13 @@ protected slots:
     void slotReload ();
 
 private:
+    void showProjects (const qtredmine::Projects &projects);
+
     Ui::ProjectListWidget *ui {nullptr};
     WidgetScroll *_w {nullptr};
+    qtredmine::RequestHandle _request;
+    qtredmine::Speculation<qtredmine::Projects> _prefetched;
+    bool _fetch {true};
 
 };
 
@@ -1,4 +1,4 @@
-QT += core gui network widgets
+QT += core gui widgets
 
 CONFIG += c++11
 
@@ -6,32 +6,22 @@ CONFIG += c++11
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+include(qtredmine/qtredmine.pri)
+
 SOURCES += \
     AuthWidget.cpp \
     IssuesWidget.cpp \
     MainDialog.cpp \
     ProjectListWidget.cpp \
     ProjectWidget.cpp \
-    main.cpp \
-    qtredmine/KeyAuthenticator.cpp \
-    qtredmine/Logging.cpp \
-    qtredmine/PasswordAuthenticator.cpp \
-    qtredmine/RedmineClient.cpp \
-    qtredmine/SimpleRedmineClient.cpp
+    main.cpp
 
 HEADERS += \
     AuthWidget.h \
     IssuesWidget.h \
     MainDialog.h \
     ProjectListWidget.h \
-    ProjectWidget.h \
-    qtredmine/Authenticator.h \
-    qtredmine/KeyAuthenticator.h \
-    qtredmine/Logging.h \
-    qtredmine/PasswordAuthenticator.h \
-    qtredmine/RedmineClient.h \
-    qtredmine/SimpleRedmineClient.h \
-    qtredmine/SimpleRedmineTypes.h
+    ProjectWidget.h
 
 FORMS += \
     AuthWidget.ui \
@@ -0,0 +1,624 @@
+#include "FastJsonDecoder.h"
+#include "StringPool.h"
+
+#include <climits>
+#include <cstring>
+
+using namespace qtredmine;
+
+namespace {
+
+/// Member name pointing into the JSON text
+struct Key
+{
+    const char *data;
+    int size;
+
+    /// Compare with a string literal
+    template<int N>
+    bool is (const char (&literal)[N]) const
+    {
+        return size == N - 1 && std::memcmp (data, literal, N - 1) == 0;
+    }
+};
+
+//!
+//! @brief Read position in a JSON text
+//!
+//! Values are converted the same way as by QJsonValue: a value of the wrong type yields the default
+//! value of the requested type. Any syntax error clears ok() and stops decoding.
+//!
+class Cursor
+{
+public:
+    explicit Cursor (const QByteArray& json)
+        : _p (json.constData ())
+        , _end (json.constData () + json.size ())
+    {}
+
+    bool ok () const { return _ok; }
+
+    //! @brief Get the next significant character without consuming it
+    char peek ()
+    {
+        skipWhitespace ();
+        return _p < _end ? *_p : '\0';
+    }
+
+    //! @brief Call \c member for every member of an object; it has to consume the value
+    template<typename F>
+    void object (F member)
+    {
+        if (!expect ('{'))
+            return;
+        if (peek () == '}') {
+            ++_p;
+            return;
+        }
+
+        while (_ok)
+        {
+            Key key;
+            if (peek () != '"') {
+                _ok = false;
+                return;
+            }
+            if (!rawString (key.data, key.size) || !expect (':'))
+                return;
+
+            member (key);
+
+            if (peek () == ',')
+                ++_p;
+            else {
+                expect ('}');
+                return;
+            }
+        }
+    }
+
+    //! @brief Call \c element for every element of an array; it has to consume the value
+    template<typename F>
+    void array (F element)
+    {
+        if (!expect ('['))
+            return;
+        if (peek () == ']') {
+            ++_p;
+            return;
+        }
+
+        while (_ok)
+        {
+            element ();
+
+            if (peek () == ',')
+                ++_p;
+            else {
+                expect (']');
+                return;
+            }
+        }
+    }
+
+    double toDouble ()
+    {
+        if (!isNumber ()) {
+            skip ();
+            return 0;
+        }
+
+        const char *start = _p;
+        bool negative = *_p == '-';
+        if (negative)
+            ++_p;
+
+        // Integers, by far the most common numbers, are converted right here
+        qint64 integer = 0;
+        int digits = 0;
+        while (_p < _end && *_p >= '0' && *_p <= '9' && digits < 18) {
+            integer = integer * 10 + (*_p++ - '0');
+            ++digits;
+        }
+
+        if (_p < _end && (*_p == '.' || *_p == 'e' || *_p == 'E' || (*_p >= '0' && *_p <= '9')))
+        {
+            while (_p < _end && std::strchr ("0123456789+-.eE", *_p))
+                ++_p;
+
+            bool ok;
+            double value = QByteArray::fromRawData (start, int (_p - start)).toDouble (&ok);
+            _ok = _ok && ok;
+            return value;
+        }
+
+        if (digits == 0)
+            _ok = false;
+
+        return negative ? -double (integer) : double (integer);
+    }
+
+    int toInt ()
+    {
+        // Like QJsonValue::toInt(), only integral numbers within range are accepted
+        if (!isNumber ()) {
+            skip ();
+            return 0;
+        }
+
+        double value = toDouble ();
+        int integer = int (value);
+        return value >= double (INT_MIN) && value <= double (INT_MAX) && double (integer) == value ? integer : 0;
+    }
+
+    bool toBool ()
+    {
+        if (match ("true"))
+            return true;
+        if (!match ("false"))
+            skip ();
+        return false;
+    }
+
+    QString toString ()
+    {
+        if (peek () != '"') {
+            skip ();
+            return QString ();
+        }
+
+        ++_p;
+        const char *start = _p;
+
+        // Most strings contain no escape sequences and are converted at once
+        while (_p < _end && *_p != '"' && *_p != '\\')
+            ++_p;
+
+        QString result = QString::fromUtf8 (start, int (_p - start));
+
+        while (_p < _end && *_p == '\\')
+        {
+            if (_end - _p < 2) {
+                _ok = false;
+                return QString ();
+            }
+
+            char escaped = _p[1];
+            _p += 2;
+
+            switch (escaped)
+            {
+            case 'b': result += QLatin1Char ('\b'); break;
+            case 'f': result += QLatin1Char ('\f'); break;
+            case 'n': result += QLatin1Char ('\n'); break;
+            case 'r': result += QLatin1Char ('\r'); break;
+            case 't': result += QLatin1Char ('\t'); break;
+
+            case 'u':
+            {
+                // UTF-16 code unit; surrogate pairs arrive as two escapes and combine in the QString
+                bool ok = _end - _p >= 4;
+                ushort code = ok ? QByteArray::fromRawData (_p, 4).toUShort (&ok, 16) : 0;
+                if (!ok) {
+                    _ok = false;
+                    return QString ();
+                }
+                result += QChar (code);
+                _p += 4;
+                break;
+            }
+
+            default:
+                result += QLatin1Char (escaped);
+                break;
+            }
+
+            start = _p;
+            while (_p < _end && *_p != '"' && *_p != '\\')
+                ++_p;
+            result += QString::fromUtf8 (start, int (_p - start));
+        }
+
+        if (!expect ('"'))
+            return QString ();
+
+        return result;
+    }
+
+    QDate toDate ()
+    {
+        const char *s;
+        int size;
+
+        if (peek () != '"') {
+            skip ();
+            return QDate ();
+        }
+        if (!rawString (s, size))
+            return QDate ();
+
+        // YYYY-MM-DD
+        if (size == 10 && s[4] == '-' && s[7] == '-')
+        {
+            int year = digits (s, 4), month = digits (s + 5, 2), day = digits (s + 8, 2);
+            if (year >= 0 && month >= 0 && day >= 0)
+                return QDate (year, month, day);
+        }
+
+        return QDate::fromString (QString::fromLatin1 (s, size), Qt::ISODate);
+    }
+
+    QDateTime toDateTime ()
+    {
+        const char *s;
+        int size;
+
+        if (peek () != '"') {
+            skip ();
+            return QDateTime ();
+        }
+        if (!rawString (s, size))
+            return QDateTime ();
+
+        // YYYY-MM-DDTHH:MM:SSZ, as Redmine sends it
+        if (size == 20 && s[4] == '-' && s[7] == '-' && s[10] == 'T' && s[13] == ':' && s[16] == ':'
+                && s[19] == 'Z')
+        {
+            int year = digits (s, 4), month = digits (s + 5, 2), day = digits (s + 8, 2);
+            int hour = digits (s + 11, 2), minute = digits (s + 14, 2), second = digits (s + 17, 2);
+
+            if (year >= 0 && month >= 0 && day >= 0 && hour >= 0 && minute >= 0 && second >= 0)
+                return QDateTime (QDate (year, month, day), QTime (hour, minute, second), Qt::UTC);
+        }
+
+        return QDateTime::fromString (QString::fromLatin1 (s, size), Qt::ISODate);
+    }
+
+    //! @brief Skip a value of any type
+    void skip ()
+    {
+        char c = peek ();
+
+        if (c == '"') {
+            toString ();
+            return;
+        }
+
+        if (c == '{' || c == '[')
+        {
+            int depth = 0;
+            while (_p < _end)
+            {
+                c = *_p;
+                if (c == '"') {
+                    toString ();
+                    continue;
+                }
+                ++_p;
+                if (c == '{' || c == '[')
+                    ++depth;
+                else if ((c == '}' || c == ']') && --depth == 0)
+                    return;
+            }
+            _ok = false;
+            return;
+        }
+
+        // Number, true, false or null
+        const char *start = _p;
+        while (_p < _end && !std::strchr (",}] \t\r\n", *_p))
+            ++_p;
+        if (_p == start)
+            _ok = false;
+    }
+
+private:
+    void skipWhitespace ()
+    {
+        while (_p < _end && (*_p == ' ' || *_p == '\n' || *_p == '\r' || *_p == '\t'))
+            ++_p;
+    }
+
+    bool expect (char c)
+    {
+        if (peek () != c) {
+            _ok = false;
+            return false;
+        }
+        ++_p;
+        return true;
+    }
+
+    template<int N>
+    bool match (const char (&literal)[N])
+    {
+        if (peek () != literal[0] || _end - _p < N - 1 || std::memcmp (_p, literal, N - 1) != 0)
+            return false;
+        _p += N - 1;
+        return true;
+    }
+
+    bool isNumber ()
+    {
+        char c = peek ();
+        return c == '-' || (c >= '0' && c <= '9');
+    }
+
+    //! @brief Read a string without escape sequences in place, e.g. a member name or a date
+    bool rawString (const char*& data, int& size)
+    {
+        ++_p;
+        data = _p;
+        while (_p < _end && *_p != '"' && *_p != '\\')
+            ++_p;
+
+        if (_p == _end || *_p != '"') {
+            _ok = false;
+            return false;
+        }
+
+        size = int (_p - data);
+        ++_p;
+        return true;
+    }
+
+    //! @brief Convert a fixed number of decimal digits, -1 if any of them is not a digit
+    static int digits (const char* s, int count)
+    {
+        int value = 0;
+        for (int i = 0; i < count; ++i) {
+            if (s[i] < '0' || s[i] > '9')
+                return -1;
+            value = value * 10 + (s[i] - '0');
+        }
+        return value;
+    }
+
+    const char *_p;
+    const char *_end;
+    bool _ok {true};
+};
+
+/// Read an item object; like fillItem(), values that are no objects and empty objects leave the item
+/// untouched, and names are interned
+bool
+readItem (Cursor& c, Item& item)
+{
+    if (c.peek () != '{') {
+        c.skip ();
+        return false;
+    }
+
+    Item parsed;
+    parsed._id = 0;
+    bool found = false;
+
+    c.object ([&](const Key& key)
+    {
+        found = true;
+
+        if (key.is ("id"))
+            parsed._id = c.toInt ();
+        else if (key.is ("name"))
+            parsed._name = StringPool::itemNames ().intern (c.toString ());
+        else
+            c.skip ();
+    } );
+
+    if (found)
+        item = parsed;
+
+    return found;
+}
+
+/// Read an array of items; elements that are no objects yield an empty item with ID 0
+void
+readItems (Cursor& c, Items& items)
+{
+    if (c.peek () != '[') {
+        c.skip ();
+        return;
+    }
+
+    c.array ([&]()
+    {
+        Item item;
+        item._id = 0;
+        readItem (c, item);
+        items.push_back (item);
+    } );
+}
+
+/// Reset the members common to all resources that the QJsonDocument based parsers always assign
+void
+resetDefaultFields (RedmineResource& resource)
+{
+    resource.createdOn = QDateTime ();
+    resource.updatedOn = QDateTime ();
+}
+
+/// Read one of the members common to all resources
+bool
+readDefaultField (Cursor& c, const Key& key, RedmineResource& resource)
+{
+    if (key.is ("created_on"))
+        resource.createdOn = c.toDateTime ();
+    else if (key.is ("updated_on"))
+        resource.updatedOn = c.toDateTime ();
+    else if (key.is ("user"))
+        readItem (c, resource.user);
+    else
+        return false;
+
+    return true;
+}
+
+/// Read an issue custom field
+CustomField
+readCustomField (Cursor& c)
+{
+    CustomField customField;
+    customField.id       = 0;
+    customField.multiple = false;
+    customField.type     = "issue";
+
+    if (c.peek () != '{') {
+        c.skip ();
+        return customField;
+    }
+
+    c.object ([&](const Key& key)
+    {
+        if (key.is ("id"))
+            customField.id = c.toInt ();
+        else if (key.is ("name"))
+            customField.name = c.toString ();
+        else if (key.is ("multiple"))
+            customField.multiple = c.toBool ();
+        else if (key.is ("value") && c.peek () == '"')
+            customField.values.push_back (c.toString ());
+        else if (key.is ("value") && c.peek () == '[')
+            c.array ([&]() { customField.values.push_back (c.toString ()); } );
+        else
+            c.skip ();
+    } );
+
+    return customField;
+}
+
+} // namespace
+
+bool
+FastJsonDecoder::decodeIssue (const QByteArray& json, Issue& issue)
+{
+    // Members that QJsonValue would convert from an absent value
+    issue.id             = 0;
+    issue.description    = QString ();
+    issue.doneRatio      = 0;
+    issue.subject        = QString ();
+    issue.dueDate        = QDate ();
+    issue.estimatedHours = 0;
+    issue.startDate      = QDate ();
+    resetDefaultFields (issue);
+
+    Cursor c (json);
+
+    c.object ([&](const Key& key)
+    {
+        if (key.is ("id"))
+            issue.id = c.toInt ();
+        else if (key.is ("subject"))
+            issue.subject = c.toString ();
+        else if (key.is ("description"))
+            issue.description = c.toString ();
+        else if (key.is ("done_ratio"))
+            issue.doneRatio = c.toInt ();
+        else if (key.is ("project"))
+            readItem (c, issue.project);
+        else if (key.is ("tracker"))
+            readItem (c, issue.tracker);
+        else if (key.is ("status"))
+            readItem (c, issue.status);
+        else if (key.is ("priority"))
+            readItem (c, issue.priority);
+        else if (key.is ("author"))
+            readItem (c, issue.author);
+        else if (key.is ("assigned_to"))
+            readItem (c, issue.assignedTo);
+        else if (key.is ("category"))
+            readItem (c, issue.category);
+        else if (key.is ("fixed_version"))
+            readItem (c, issue.version);
+        else if (key.is ("parent"))
+        {
+            Item parent;
+            if (readItem (c, parent))
+                issue.parentId = parent._id;
+        }
+        else if (key.is ("start_date"))
+            issue.startDate = c.toDate ();
+        else if (key.is ("due_date"))
+            issue.dueDate = c.toDate ();
+        else if (key.is ("estimated_hours"))
+            issue.estimatedHours = c.toDouble ();
+        else if (key.is ("custom_fields") && c.peek () == '[')
+            c.array ([&]() { issue.customFields.push_back (readCustomField (c)); } );
+        else if (!readDefaultField (c, key, issue))
+            c.skip ();
+    } );
+
+    return c.ok ();
+}
+
+bool
+FastJsonDecoder::decodeProject (const QByteArray& json, Project& project)
+{
+    // Members that QJsonValue would convert from an absent value
+    project._id          = 0;
+    project._name        = QString ();
+    project._identifier  = QString ();
+    project._description = QString ();
+    project._isPublic    = false;
+    resetDefaultFields (project);
+
+    Cursor c (json);
+
+    c.object ([&](const Key& key)
+    {
+        if (key.is ("id"))
+            project._id = c.toInt ();
+        else if (key.is ("name"))
+            project._name = c.toString ();
+        else if (key.is ("identifier"))
+            project._identifier = c.toString ();
+        else if (key.is ("description"))
+            project._description = c.toString ();
+        else if (key.is ("is_public"))
+            project._isPublic = c.toBool ();
+        else if (key.is ("parent"))
+            readItem (c, project._parent);
+        else if (key.is ("trackers"))
+            readItems (c, project._trackers);
+        else if (key.is ("issue_categories"))
+            readItems (c, project._categories);
+        else if (!readDefaultField (c, key, project))
+            c.skip ();
+    } );
+
+    return c.ok ();
+}
+
+bool
+FastJsonDecoder::decodeTimeEntry (const QByteArray& json, TimeEntry& timeEntry)
+{
+    // Members that QJsonValue would convert from an absent value
+    timeEntry.id      = 0;
+    timeEntry.hours   = 0;
+    timeEntry.comment = QString ();
+    timeEntry.spentOn = QDate ();
+    resetDefaultFields (timeEntry);
+
+    Cursor c (json);
+
+    c.object ([&](const Key& key)
+    {
+        if (key.is ("id"))
+            timeEntry.id = c.toInt ();
+        else if (key.is ("hours"))
+            timeEntry.hours = c.toDouble ();
+        else if (key.is ("comments"))
+            timeEntry.comment = c.toString ();
+        else if (key.is ("spent_on"))
+            timeEntry.spentOn = c.toDate ();
+        else if (key.is ("project"))
+            readItem (c, timeEntry.project);
+        else if (key.is ("issue"))
+            readItem (c, timeEntry.issue);
+        else if (key.is ("activity"))
+            readItem (c, timeEntry.activity);
+        else if (!readDefaultField (c, key, timeEntry))
+            c.skip ();
+    } );
+
+    return c.ok ();
+}
@@ -0,0 +1,48 @@
+#ifndef FAST_JSON_DECODER_H
+#define FAST_JSON_DECODER_H
+
+#include "SimpleRedmineTypes.h"
+
+#include <QtCore/QByteArray>
+
+namespace qtredmine {
+
+//!
+//! @brief Decoder from the Redmine wire format straight into the data containers
+//!
+//! The decoder walks the JSON text once and fills the structure member by member, without building
+//! a QJsonDocument, without hashing keys and without converting dates through QVariant. Members
+//! that are not needed are skipped. The result is the same as that of the QJsonDocument based
+//! parsers in SimpleRedmineClient.
+//!
+class FastJsonDecoder
+{
+public:
+    //! @brief Decode an issue
+    //!
+    //! @param json  JSON text of one issue object
+    //! @param issue Issue to fill
+    //!
+    //! @return true on success, false if the text is not a valid issue object
+    static bool decodeIssue (const QByteArray& json, Issue& issue);
+
+    //! @brief Decode a project
+    //!
+    //! @param json    JSON text of one project object
+    //! @param project Project to fill
+    //!
+    //! @return true on success, false if the text is not a valid project object
+    static bool decodeProject (const QByteArray& json, Project& project);
+
+    //! @brief Decode a time entry
+    //!
+    //! @param json      JSON text of one time entry object
+    //! @param timeEntry Time entry to fill
+    //!
+    //! @return true on success, false if the text is not a valid time entry object
+    static bool decodeTimeEntry (const QByteArray& json, TimeEntry& timeEntry);
+};
+
+} // qtredmine
+
+#endif // FAST_JSON_DECODER_H
@@ -0,0 +1,144 @@
+#include "IssueSyncEngine.h"
+
+using namespace qtredmine;
+
+IssueSyncEngine::IssueSyncEngine (SimpleRedmineClient* client)
+    : _client (client)
+{}
+
+IssueSyncEngine::~IssueSyncEngine ()
+{
+    // Cancelled requests drop their callbacks, so none of them runs into a deleted engine
+    for (Set &set : _sets)
+        set.request.cancel ();
+}
+
+void
+IssueSyncEngine::setLocalStore (LocalStore* store)
+{
+    _store = store;
+}
+
+RequestHandle
+IssueSyncEngine::sync (const RedmineQuery& query, SyncCb callback, int maxParallelRequests,
+                       RequestPriority priority)
+{
+    const QString key = query.toString ();
+
+    // The first sync after a restart continues from the stored state
+    bool known = _sets.contains (key);
+    Set &set = _sets[key];
+    if (!known && _store) {
+        Issues stored;
+        if (_store->syncState (key, set.cursor, set.fingerprint, stored))
+            for (const Issue &issue : stored)
+                set.issues.insert (issue.id, issue);
+    }
+
+    set.request.cancel ();
+    set.request = RequestHandle ();
+
+    // A single issue tells whether anything has changed since the last sync
+    auto probed = [=](ListFingerprint fingerprint, RedmineError redmineError, QStringList errors)
+    {
+        Set &set = _sets[key];
+
+        if (redmineError != RedmineError::NO_ERR || fingerprint == set.fingerprint) {
+            set.request = RequestHandle ();
+            callback (Changes (), redmineError, errors);
+            return;
+        }
+
+        set.request.add (fetch (query, fingerprint, callback, maxParallelRequests, priority));
+    };
+
+    set.request.add (_client->probeIssues (probed, query, priority));
+
+    return set.request;
+}
+
+RequestHandle
+IssueSyncEngine::fetch (const RedmineQuery& query, const ListFingerprint& fingerprint, SyncCb callback,
+                        int maxParallelRequests, RequestPriority priority)
+{
+    const QString key = query.toString ();
+    const Set &set = _sets[key];
+
+    // Redmine compares whole seconds, so the issues updated at the cursor itself come again; they are
+    // only reported if they have actually changed
+    RedmineQuery delta = query;
+    if (set.cursor.isValid ())
+        delta.updatedOn (set.cursor);
+    delta.sort ("updated_on");
+
+    auto cb = [this, key, fingerprint, callback](Issues issues, RedmineError redmineError, QStringList errors)
+    {
+        Set &set = _sets[key];
+        set.request = RequestHandle ();
+
+        Changes changes;
+        if (redmineError != RedmineError::NO_ERR) {
+            callback (changes, redmineError, errors);
+            return;
+        }
+
+        Issues merged;
+        for (const Issue &issue : issues)
+        {
+            auto it = set.issues.find (issue.id);
+            if (it == set.issues.end ())
+                changes.added.append (issue.id);
+            else if (it->updatedOn != issue.updatedOn)
+                changes.changed.append (issue.id);
+            else
+                continue;
+
+            set.issues.insert (issue.id, issue);
+            merged.append (issue);
+            if (!set.cursor.isValid () || issue.updatedOn > set.cursor)
+                set.cursor = issue.updatedOn;
+        }
+
+        // Issues updated after the probe make the next probe differ, so they are not missed
+        set.fingerprint = fingerprint;
+
+        if (_store) {
+            _store->storeIssues (merged);
+            _store->storeSyncState (key, set.cursor, set.fingerprint, changes.added);
+            _store->updateSnapshot (merged);
+        }
+
+        callback (changes, RedmineError::NO_ERR, QStringList ());
+    };
+
+    RedmineOptions options (delta, true, maxParallelRequests, priority);
+    return _client->retrieveIssues (cb, options);
+}
+
+QHash<int, Issue>
+IssueSyncEngine::issues (const RedmineQuery& query) const
+{
+    return _sets.value (query.toString ()).issues;
+}
+
+QDateTime
+IssueSyncEngine::cursor (const RedmineQuery& query) const
+{
+    return _sets.value (query.toString ()).cursor;
+}
+
+void
+IssueSyncEngine::reset (const RedmineQuery& query)
+{
+    const QString key = query.toString ();
+
+    if (_store)
+        _store->removeSyncState (key);
+
+    auto it = _sets.find (key);
+    if (it == _sets.end ())
+        return;
+
+    it->request.cancel ();
+    _sets.erase (it);
+}
@@ -0,0 +1,120 @@
+#ifndef ISSUE_SYNC_ENGINE_H
+#define ISSUE_SYNC_ENGINE_H
+
+#include "LocalStore.h"
+#include "RedmineQuery.h"
+#include "SimpleRedmineClient.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+
+#include <functional>
+
+namespace qtredmine {
+
+//!
+//! @brief Local copy of the issues matching a query, refreshed with the changes only
+//!
+//! The first sync() of a query fetches all matching issues. Every later sync() only asks for issues
+//! updated since the latest \c updated_on seen so far, the high-water mark of the query, and merges
+//! them into the local set. For a large project a refresh thus transfers a few issues instead of
+//! hundreds of pages. Before that, SimpleRedmineClient::probeIssues() checks whether anything has
+//! changed at all; if not, the sync ends after a single small request.
+//!
+//! Deleted issues, and issues that no longer match the query's filters, are not noticed; filter with
+//! RedmineQuery::status(RedmineQuery::Any) to keep closed issues in sync, and call reset() to start
+//! over.
+//!
+//! With a local store, the merged issues and the high-water mark survive restarts: the first sync() of a
+//! query after a restart continues where the last one ended.
+//!
+//! Callbacks are called on the thread calling sync(), unless the client has a callback context; the
+//! engine has to be used on that thread only.
+//!
+class IssueSyncEngine
+{
+public:
+    /// Issues changed by a sync
+    struct Changes
+    {
+        QVector<int> added;   ///< IDs of issues that were not in the local set
+        QVector<int> changed; ///< IDs of issues that were updated since the last sync
+    };
+
+    /// Callback with the changes of a sync
+    using SyncCb = std::function<void(Changes, RedmineError, QStringList)>;
+
+    //! @brief Constructor for an engine without local issues
+    //! @param client Client to retrieve the issues with
+    explicit IssueSyncEngine (SimpleRedmineClient* client);
+
+    //! @brief Destructor; cancels running syncs
+    ~IssueSyncEngine ();
+
+    //! @brief Set the store keeping the issues and high-water marks across restarts
+    //! @param store Local store, nullptr to keep them in memory only
+    void setLocalStore (LocalStore* store);
+
+    //! @brief Bring the local issues of a query up to date
+    //!
+    //! A running sync of the same query is cancelled. On error the local issues and the high-water
+    //! mark are left unchanged.
+    //!
+    //! @param query               Query selecting the issues
+    //! @param callback            Callback function with the added and changed issues
+    //! @param maxParallelRequests Maximum number of page requests in flight
+    //! @param priority            Scheduling priority of the requests
+    //!
+    //! @return Handle to cancel the sync
+    RequestHandle sync (const RedmineQuery& query, SyncCb callback, int maxParallelRequests = 4,
+                        RequestPriority priority = RequestPriority::Background);
+
+    //! @brief Get the local issues of a query
+    //! @param query Query selecting the issues
+    //! @return Issues by ID, empty before the first sync
+    QHash<int, Issue> issues (const RedmineQuery& query) const;
+
+    //! @brief Get the high-water mark of a query
+    //! @param query Query selecting the issues
+    //! @return Latest \c updated_on of the local issues, invalid before the first sync
+    QDateTime cursor (const RedmineQuery& query) const;
+
+    //! @brief Drop the local issues of a query, so that the next sync fetches all of them
+    //! @param query Query selecting the issues
+    void reset (const RedmineQuery& query);
+
+private:
+    /// Local state of a query
+    struct Set
+    {
+        QHash<int, Issue> issues;      ///< Issues by ID
+        QDateTime         cursor;      ///< Latest \c updated_on of the issues
+        ListFingerprint   fingerprint; ///< Probe result of the last successful sync
+        RequestHandle     request;     ///< Running sync
+    };
+
+    //! @brief Fetch the issues updated since the high-water mark and merge them
+    //!
+    //! @param query               Query selecting the issues
+    //! @param fingerprint         Probe result to store once the issues are merged
+    //! @param callback            Callback function with the added and changed issues
+    //! @param maxParallelRequests Maximum number of page requests in flight
+    //! @param priority            Scheduling priority of the requests
+    //!
+    //! @return Handle to cancel the requests
+    RequestHandle fetch (const RedmineQuery& query, const ListFingerprint& fingerprint, SyncCb callback,
+                         int maxParallelRequests, RequestPriority priority);
+
+    /// Client to retrieve the issues with
+    SimpleRedmineClient* _client {nullptr};
+
+    /// Store keeping the local state across restarts
+    LocalStore* _store {nullptr};
+
+    /// Local state by canonical query string
+    QHash<QString, Set> _sets;
+};
+
+} // qtredmine
+
+#endif // ISSUE_SYNC_ENGINE_H
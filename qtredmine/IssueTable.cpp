@@ -0,0 +1,253 @@
+#include "IssueTable.h"
+
+#include <limits>
+#include <numeric>
+
+using namespace qtredmine;
+
+/// Stored value of an invalid time or date
+static const qint64 INVALID_TIME = std::numeric_limits<qint64>::min ();
+
+static qint64
+storedTime (const QDateTime& time)
+{
+    return time.isValid () ? time.toMSecsSinceEpoch () : INVALID_TIME;
+}
+
+static QDateTime
+loadedTime (qint64 time)
+{
+    return time == INVALID_TIME ? QDateTime () : QDateTime::fromMSecsSinceEpoch (time, Qt::UTC);
+}
+
+/// Item of an issue in a column
+static const Item&
+issueItem (const Issue& issue, IssueTable::ItemColumn column)
+{
+    switch (column)
+    {
+    case IssueTable::AssignedTo: return issue.assignedTo;
+    case IssueTable::Author:     return issue.author;
+    case IssueTable::Category:   return issue.category;
+    case IssueTable::Priority:   return issue.priority;
+    case IssueTable::Project:    return issue.project;
+    case IssueTable::Status:     return issue.status;
+    case IssueTable::Tracker:    return issue.tracker;
+    case IssueTable::Version:    return issue.version;
+    case IssueTable::User:       return issue.user;
+    }
+
+    return issue.user;
+}
+
+static Item&
+issueItem (Issue& issue, IssueTable::ItemColumn column)
+{
+    return const_cast<Item&> (issueItem (const_cast<const Issue&> (issue), column));
+}
+
+/**
+ * @brief Keep the rows whose value in a column matches
+ *
+ * @param rows    Rows, narrowed in place
+ * @param column  Column to check
+ * @param matches Predicate on a value of the column
+ */
+template<typename T, typename Predicate>
+static void
+narrow (QVector<int>& rows, const QVector<T>& column, Predicate matches)
+{
+    int kept = 0;
+    for (int i = 0; i < rows.size (); ++i)
+        if (matches (column[rows[i]]))
+            rows[kept++] = rows[i];
+    rows.resize (kept);
+}
+
+IssueTable::IssueTable ()
+{}
+
+IssueTable::IssueTable (const Issues& issues)
+{
+    append (issues);
+}
+
+void
+IssueTable::append (const Issues& issues)
+{
+    int capacity = size () + issues.size ();
+    _ids.reserve (capacity);
+    _parentIds.reserve (capacity);
+    for (int column = 0; column < ITEM_COLUMNS; ++column) {
+        _itemIds[column].reserve (capacity);
+        _itemNames[column].reserve (capacity);
+    }
+    _createdOn.reserve (capacity);
+    _updatedOn.reserve (capacity);
+    _startDates.reserve (capacity);
+    _dueDates.reserve (capacity);
+    _doneRatios.reserve (capacity);
+    _estimatedHours.reserve (capacity);
+    _details.reserve (capacity);
+
+    for (const Issue &issue : issues)
+    {
+        int row = _rows.value (issue.id, -1);
+        if (row < 0) {
+            row = size ();
+            _rows.insert (issue.id, row);
+
+            _ids.append (issue.id);
+            _parentIds.append (NULL_ID);
+            for (int column = 0; column < ITEM_COLUMNS; ++column) {
+                _itemIds[column].append (NULL_ID);
+                _itemNames[column].append (0);
+            }
+            _createdOn.append (INVALID_TIME);
+            _updatedOn.append (INVALID_TIME);
+            _startDates.append (INVALID_TIME);
+            _dueDates.append (INVALID_TIME);
+            _doneRatios.append (0);
+            _estimatedHours.append (0);
+            _details.append (Details ());
+        }
+
+        set (row, issue);
+    }
+}
+
+void
+IssueTable::set (int row, const Issue& issue)
+{
+    _parentIds[row] = issue.parentId;
+    for (int column = 0; column < ITEM_COLUMNS; ++column) {
+        const Item &item = issueItem (issue, ItemColumn (column));
+        _itemIds[column][row] = item._id;
+        _itemNames[column][row] = nameIndex (item._name);
+    }
+    _createdOn[row] = storedTime (issue.createdOn);
+    _updatedOn[row] = storedTime (issue.updatedOn);
+    _startDates[row] = issue.startDate.toJulianDay ();
+    _dueDates[row] = issue.dueDate.toJulianDay ();
+    _doneRatios[row] = issue.doneRatio;
+    _estimatedHours[row] = issue.estimatedHours;
+
+    Details &details = _details[row];
+    details.subject = issue.subject;
+    details.description = issue.description;
+    details.customFields = issue.customFields;
+}
+
+int
+IssueTable::nameIndex (const QString& name)
+{
+    auto it = _nameIndices.constFind (name);
+    if (it != _nameIndices.constEnd ())
+        return it.value ();
+
+    int index = _names.size ();
+    _names.append (name);
+    _nameIndices.insert (name, index);
+    return index;
+}
+
+void
+IssueTable::clear ()
+{
+    *this = IssueTable ();
+}
+
+int
+IssueTable::size () const
+{
+    return _ids.size ();
+}
+
+int
+IssueTable::row (int id) const
+{
+    return _rows.value (id, -1);
+}
+
+Issue
+IssueTable::issue (int row) const
+{
+    const Details &details = _details[row];
+
+    Issue issue;
+    issue.id = _ids[row];
+    issue.parentId = _parentIds[row];
+    issue.subject = details.subject;
+    issue.description = details.description;
+    issue.customFields = details.customFields;
+    for (int column = 0; column < ITEM_COLUMNS; ++column) {
+        Item &item = issueItem (issue, ItemColumn (column));
+        item._id = _itemIds[column][row];
+        item._name = _names[_itemNames[column][row]];
+    }
+    issue.createdOn = loadedTime (_createdOn[row]);
+    issue.updatedOn = loadedTime (_updatedOn[row]);
+    issue.startDate = QDate::fromJulianDay (_startDates[row]);
+    issue.dueDate = QDate::fromJulianDay (_dueDates[row]);
+    issue.doneRatio = _doneRatios[row];
+    issue.estimatedHours = _estimatedHours[row];
+
+    return issue;
+}
+
+QString
+IssueTable::itemName (ItemColumn column, int row) const
+{
+    return _names[_itemNames[column][row]];
+}
+
+const QVector<int>& IssueTable::ids () const                        { return _ids; }
+const QVector<int>& IssueTable::parentIds () const                  { return _parentIds; }
+const QVector<int>& IssueTable::itemIds (ItemColumn column) const   { return _itemIds[column]; }
+const QVector<qint64>& IssueTable::createdOn () const               { return _createdOn; }
+const QVector<qint64>& IssueTable::updatedOn () const               { return _updatedOn; }
+const QVector<qint64>& IssueTable::startDates () const              { return _startDates; }
+const QVector<qint64>& IssueTable::dueDates () const                { return _dueDates; }
+const QVector<double>& IssueTable::doneRatios () const              { return _doneRatios; }
+const QVector<double>& IssueTable::estimatedHours () const          { return _estimatedHours; }
+
+QVector<int>
+IssueTable::select (const Filter& filter) const
+{
+    QVector<int> rows (size ());
+    std::iota (rows.begin (), rows.end (), 0);
+
+    // Each condition narrows the rows of the previous one, so every pass reads a single column
+    if (filter.projectId != NULL_ID)
+        narrow (rows, _itemIds[Project], [&](int id) { return id == filter.projectId; });
+    if (filter.statusId != NULL_ID)
+        narrow (rows, _itemIds[Status], [&](int id) { return id == filter.statusId; });
+    if (filter.trackerId != NULL_ID)
+        narrow (rows, _itemIds[Tracker], [&](int id) { return id == filter.trackerId; });
+    if (filter.assignedToId != NULL_ID)
+        narrow (rows, _itemIds[AssignedTo], [&](int id) { return id == filter.assignedToId; });
+    if (filter.updatedSince.isValid ()) {
+        qint64 since = storedTime (filter.updatedSince);
+        narrow (rows, _updatedOn, [&](qint64 time) { return time >= since; });
+    }
+
+    return rows;
+}
+
+double
+IssueTable::sum (const QVector<double>& column, const QVector<int>& rows)
+{
+    double result = 0;
+    for (int row : rows)
+        result += column[row];
+    return result;
+}
+
+QHash<int, double>
+IssueTable::sumBy (const QVector<int>& keys, const QVector<double>& column, const QVector<int>& rows)
+{
+    QHash<int, double> result;
+    for (int row : rows)
+        result[keys[row]] += column[row];
+    return result;
+}
@@ -0,0 +1,195 @@
+#ifndef ISSUE_TABLE_H
+#define ISSUE_TABLE_H
+
+#include "SimpleRedmineTypes.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QHash>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+#include <algorithm>
+
+namespace qtredmine {
+
+//!
+//! @brief Column-wise copy of issues for filtering, sorting and aggregation
+//!
+//! Every scalar field is kept in a contiguous column, so a scan over statuses or estimated hours
+//! touches only that column instead of whole Issue structures. Item names are dictionary-encoded and
+//! stored once per distinct name. Subjects, descriptions and custom fields are kept apart and only
+//! read when an issue is materialised by issue().
+//!
+//! Filters return row numbers, which can then be sorted by a column and aggregated:
+//!
+//!     QVector<int> rows = table.select (filter);
+//!     IssueTable::sort (rows, table.updatedOn (), Qt::DescendingOrder);
+//!     double hours = IssueTable::sum (table.estimatedHours (), rows);
+//!
+//! Times are stored as milliseconds since the epoch and dates as julian days; invalid ones as the
+//! smallest qint64, so they sort first.
+//!
+class IssueTable
+{
+public:
+    /// Item columns
+    enum ItemColumn {
+        AssignedTo, ///< Assigned to user
+        Author,     ///< Author
+        Category,   ///< Category
+        Priority,   ///< Priority
+        Project,    ///< Project
+        Status,     ///< Status
+        Tracker,    ///< Tracker
+        Version,    ///< Version
+        User,       ///< Redmine user
+    };
+
+    /// Issue selection, unset members match all issues
+    struct Filter
+    {
+        int       projectId    = NULL_ID; ///< Project
+        int       statusId     = NULL_ID; ///< Issue status
+        int       trackerId    = NULL_ID; ///< Tracker
+        int       assignedToId = NULL_ID; ///< Assigned user or group
+        QDateTime updatedSince;           ///< Earliest update time
+    };
+
+    //! @brief Constructor for an empty table
+    IssueTable ();
+
+    //! @brief Constructor for a table of issues
+    //! @param issues Issues
+    explicit IssueTable (const Issues& issues);
+
+    //! @brief Insert or update issues
+    //!
+    //! New issues are appended; issues already in the table are updated in their row.
+    //!
+    //! @param issues Issues, e.g. a page of a retrieval
+    void append (const Issues& issues);
+
+    //! @brief Remove all issues
+    void clear ();
+
+    //! @brief Get the number of issues
+    int size () const;
+
+    //! @brief Find an issue by ID
+    //! @param id Issue ID
+    //! @return Row of the issue, -1 if the table does not hold it
+    int row (int id) const;
+
+    //! @brief Materialise an issue
+    //! @param row Row, from 0 to size() - 1
+    //! @return Issue
+    Issue issue (int row) const;
+
+    //! @brief Get the name of an item
+    //!
+    //! @param column Item column
+    //! @param row    Row, from 0 to size() - 1
+    //!
+    //! @return Item name
+    QString itemName (ItemColumn column, int row) const;
+
+    /// @name Columns, indexed by row
+    /// @{
+    const QVector<int>& ids () const;
+    const QVector<int>& parentIds () const;
+    const QVector<int>& itemIds (ItemColumn column) const;
+    const QVector<qint64>& createdOn () const;
+    const QVector<qint64>& updatedOn () const;
+    const QVector<qint64>& startDates () const;
+    const QVector<qint64>& dueDates () const;
+    const QVector<double>& doneRatios () const;
+    const QVector<double>& estimatedHours () const;
+    /// @}
+
+    //! @brief Select issues
+    //! @param filter Issue selection
+    //! @return Rows of the matching issues in ascending order
+    QVector<int> select (const Filter& filter) const;
+
+    //! @brief Sort rows by a column; rows with equal values keep their order
+    //!
+    //! @param rows   Rows to sort
+    //! @param column Column to sort by
+    //! @param order  Sort order
+    template<typename T>
+    static void sort (QVector<int>& rows, const QVector<T>& column, Qt::SortOrder order = Qt::AscendingOrder)
+    {
+        if (order == Qt::AscendingOrder)
+            std::stable_sort (rows.begin (), rows.end (), [&](int a, int b) { return column[a] < column[b]; });
+        else
+            std::stable_sort (rows.begin (), rows.end (), [&](int a, int b) { return column[b] < column[a]; });
+    }
+
+    //! @brief Sum up a column
+    //!
+    //! @param column Column to sum up
+    //! @param rows   Rows to sum up
+    //!
+    //! @return Sum
+    static double sum (const QVector<double>& column, const QVector<int>& rows);
+
+    //! @brief Sum up a column per key
+    //!
+    //! @param keys   Column to group by, e.g. itemIds (Status)
+    //! @param column Column to sum up
+    //! @param rows   Rows to sum up
+    //!
+    //! @return Sum per key
+    static QHash<int, double> sumBy (const QVector<int>& keys, const QVector<double>& column,
+                                     const QVector<int>& rows);
+
+private:
+    /// Number of item columns
+    static const int ITEM_COLUMNS = User + 1;
+
+    /// Fields that are not filtered, sorted or aggregated
+    struct Details
+    {
+        QString      subject;      ///< Subject
+        QString      description;  ///< Description
+        CustomFields customFields; ///< Custom fields
+    };
+
+    //! @brief Set the fields of a row
+    //! @param row   Row, from 0 to size() - 1
+    //! @param issue Issue
+    void set (int row, const Issue& issue);
+
+    //! @brief Get the dictionary index of a name, adding the name if needed
+    //! @param name Name
+    //! @return Index into _names
+    int nameIndex (const QString& name);
+
+    /// @name Columns
+    /// @{
+    QVector<int>    _ids;
+    QVector<int>    _parentIds;
+    QVector<int>    _itemIds[ITEM_COLUMNS];
+    QVector<int>    _itemNames[ITEM_COLUMNS]; ///< Indices into _names
+    QVector<qint64> _createdOn;
+    QVector<qint64> _updatedOn;
+    QVector<qint64> _startDates;
+    QVector<qint64> _dueDates;
+    QVector<double> _doneRatios;
+    QVector<double> _estimatedHours;
+    QVector<Details> _details;
+    /// @}
+
+    /// Distinct item names
+    QVector<QString> _names;
+
+    /// Dictionary index of every distinct item name
+    QHash<QString, int> _nameIndices;
+
+    /// Row of every issue ID
+    QHash<int, int> _rows;
+};
+
+} // qtredmine
+
+#endif // ISSUE_TABLE_H
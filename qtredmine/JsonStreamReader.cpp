@@ -0,0 +1,149 @@
+#include "JsonStreamReader.h"
+
+using namespace qtredmine;
+
+/// Nesting depth of the streamed array's elements: inside the top-level object and the array
+static const int ELEMENT_DEPTH = 2;
+
+JsonStreamReader::JsonStreamReader (const QByteArray& arrayKey, ElementCb callback)
+    : _arrayKey (arrayKey)
+    , _callback (callback)
+{}
+
+void
+JsonStreamReader::addData (const QByteArray& data)
+{
+    // Runs of characters are copied at once to the envelope or element they belong to
+    enum Sink { Envelope, Element, Skip };
+
+    const char *d = data.constData ();
+    const int size = data.size ();
+
+    Sink runSink = Envelope;
+    int runStart = 0;
+
+    auto flush = [&](int end)
+    {
+        if (runSink == Envelope)
+            _envelope.append (d + runStart, end - runStart);
+        else if (runSink == Element)
+            _element.append (d + runStart, end - runStart);
+        runStart = end;
+    };
+
+    for (int i = 0; i < size; ++i)
+    {
+        const char c = d[i];
+        bool elementDone = false;
+
+        if (_inString)
+        {
+            if (_escaped)
+                _escaped = false;
+            else if (c == '\\')
+                _escaped = true;
+            else if (c == '"') {
+                _inString = false;
+                if (_depth == 1)
+                    _lastKey = _string;
+            }
+            else if (_depth == 1)
+                _string.append (c);
+        }
+        else
+        {
+            switch (c)
+            {
+            case '"':
+                _inString = true;
+                _string.clear ();
+                break;
+
+            case '{':
+            case '[':
+                ++_depth;
+                break;
+
+            case '}':
+            case ']':
+                if (_inArray && _depth == ELEMENT_DEPTH)
+                    _inArray = false;   // End of the streamed array
+                else if (_inArray && _depth == ELEMENT_DEPTH + 1)
+                    elementDone = true;
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        // Characters of an element, including its braces, go to the element; separators between
+        // elements are dropped; everything else makes up the envelope
+        Sink sink = !_inArray ? Envelope : _depth > ELEMENT_DEPTH ? Element : Skip;
+
+        if (sink != runSink) {
+            flush (i);
+            runSink = sink;
+        }
+
+        if (!_inString && (c == '}' || c == ']'))
+            --_depth;
+
+        if (elementDone) {
+            flush (i + 1);
+            emitElement ();
+        }
+
+        // The array starts after its bracket, which stays in the envelope
+        if (!_inString && c == '[' && _depth == ELEMENT_DEPTH && !_inArray && _lastKey == _arrayKey) {
+            flush (i + 1);
+            _inArray = true;
+            runSink = Skip;
+        }
+    }
+
+    flush (size);
+}
+
+void
+JsonStreamReader::emitElement ()
+{
+    QByteArray element = _element;
+    _element.clear ();
+
+    // Skip elements that were already handed out before a restart
+    if (++_seen <= _delivered)
+        return;
+
+    ++_delivered;
+
+    if (_callback)
+        _callback (element);
+}
+
+void
+JsonStreamReader::restart ()
+{
+    _envelope.clear ();
+    _element.clear ();
+    _string.clear ();
+    _lastKey.clear ();
+
+    _depth = 0;
+    _inString = false;
+    _escaped = false;
+    _inArray = false;
+    _seen = 0;
+}
+
+QJsonDocument
+JsonStreamReader::envelope () const
+{
+    return QJsonDocument::fromJson (_envelope);
+}
+
+int
+JsonStreamReader::count () const
+{
+    return _delivered;
+}
@@ -0,0 +1,84 @@
+#ifndef JSON_STREAM_READER_H
+#define JSON_STREAM_READER_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QJsonDocument>
+
+#include <functional>
+
+namespace qtredmine {
+
+//!
+//! @brief Incremental decoder for Redmine list responses
+//!
+//! Redmine returns lists as an object with one array member, e.g.
+//! <tt>{"issues":[{...},{...}],"total_count":2,"offset":0,"limit":25}</tt>. The reader is fed the
+//! response in chunks as they arrive and hands out the data of each element of that array as soon as
+//! its closing brace has been received, so decoding overlaps the download and no document for the
+//! whole response is ever built. All other members are collected into a small envelope document.
+//!
+class JsonStreamReader
+{
+public:
+    /// Typedef for a callback function receiving the JSON text of one array element
+    using ElementCb = std::function<void(const QByteArray&)>;
+
+    //! @brief Constructor
+    //!
+    //! @param arrayKey Name of the array member whose elements are streamed, e.g. \c issues
+    //! @param callback Callback function called for every element, in order
+    JsonStreamReader (const QByteArray& arrayKey, ElementCb callback);
+
+    //! @brief Decode the next chunk of the response
+    //! @param data Response data following the previously added data
+    void addData (const QByteArray& data);
+
+    //! @brief Start over with a new response to the same request
+    //!
+    //! Used when a request is retried; elements that have already been handed to the callback are
+    //! skipped when they arrive again.
+    void restart ();
+
+    //! @brief Get the response without the array elements
+    //!
+    //! @return Envelope document, e.g. <tt>{"issues":[],"total_count":2}</tt>; for error responses
+    //!         the complete document
+    QJsonDocument envelope () const;
+
+    //! @brief Get the number of elements handed to the callback
+    //! @return Number of elements
+    int count () const;
+
+private:
+    //! @brief Hand a complete element to the callback
+    void emitElement ();
+
+    /// Name of the streamed array member
+    QByteArray _arrayKey;
+
+    /// Element callback
+    ElementCb _callback;
+
+    /// Response without the array elements
+    QByteArray _envelope;
+
+    /// Data of the element being received
+    QByteArray _element;
+
+    /// Current top-level string, to recognise the array member's key
+    QByteArray _string;
+
+    /// Last complete top-level string
+    QByteArray _lastKey;
+
+    int  _depth {0};          ///< Current nesting depth of objects and arrays
+    bool _inString {false};   ///< Inside a string
+    bool _escaped {false};    ///< The previous character was a backslash inside a string
+    bool _inArray {false};    ///< Inside the streamed array
+    int  _seen {0};           ///< Elements received in the current response
+    int  _delivered {0};      ///< Elements handed to the callback
+};
+
+} // qtredmine
+
+#endif // JSON_STREAM_READER_H
@@ -0,0 +1,987 @@
+#include "LocalStore.h"
+#include "StringPool.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSet>
+#include <QtCore/QStandardPaths>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+
+#include <algorithm>
+
+using namespace qtredmine;
+
+LocalStore *LocalStore::_instance = nullptr;
+
+/// Format version of the stored resources; databases of other versions are emptied
+static const int STORE_VERSION = 1;
+
+/// Number of the next database connection
+static QAtomicInt nextConnection (0);
+
+/// @name Serialisation of the resources
+/// @{
+
+static void save (QDataStream& out, const Item& item)
+{
+    out << item._id << item._name;
+}
+
+static void load (QDataStream& in, Item& item)
+{
+    in >> item._id >> item._name;
+    item._name = StringPool::itemNames ().intern (item._name);
+}
+
+template<typename T>
+static void save (QDataStream& out, const QVector<T>& items)
+{
+    out << quint32 (items.size ());
+    for (const T &item : items)
+        save (out, item);
+}
+
+template<typename T>
+static void load (QDataStream& in, QVector<T>& items)
+{
+    quint32 size = 0;
+    in >> size;
+
+    // A corrupt size must not allocate more than the stream can hold
+    items.clear ();
+    for (quint32 i = 0; i < size && in.status () == QDataStream::Ok; ++i) {
+        T item;
+        load (in, item);
+        items.append (item);
+    }
+}
+
+static void writeResource (QDataStream& out, const RedmineResource& resource)
+{
+    out << resource.createdOn << resource.updatedOn;
+    save (out, resource.user);
+}
+
+static void readResource (QDataStream& in, RedmineResource& resource)
+{
+    in >> resource.createdOn >> resource.updatedOn;
+    load (in, resource.user);
+}
+
+static void save (QDataStream& out, const CustomField& field)
+{
+    out << field.id << field.name << field.values << field.possibleValues << field.defaultValue
+        << field.type << field.format << field.regex << field.minLength << field.maxLength
+        << field.allProjects << field.isRequired << field.isFilter << field.searchable << field.multiple
+        << field.visible;
+    save (out, field.projects);
+    save (out, field.trackers);
+}
+
+static void load (QDataStream& in, CustomField& field)
+{
+    in >> field.id >> field.name >> field.values >> field.possibleValues >> field.defaultValue
+       >> field.type >> field.format >> field.regex >> field.minLength >> field.maxLength
+       >> field.allProjects >> field.isRequired >> field.isFilter >> field.searchable >> field.multiple
+       >> field.visible;
+    load (in, field.projects);
+    load (in, field.trackers);
+}
+
+static void save (QDataStream& out, const Issue& issue)
+{
+    writeResource (out, issue);
+    out << issue.id << issue.parentId << issue.description << issue.doneRatio << issue.subject;
+    save (out, issue.assignedTo);
+    save (out, issue.author);
+    save (out, issue.category);
+    save (out, issue.priority);
+    save (out, issue.project);
+    save (out, issue.status);
+    save (out, issue.tracker);
+    save (out, issue.version);
+    out << issue.dueDate << issue.estimatedHours << issue.startDate;
+    save (out, issue.customFields);
+}
+
+static void load (QDataStream& in, Issue& issue)
+{
+    readResource (in, issue);
+    in >> issue.id >> issue.parentId >> issue.description >> issue.doneRatio >> issue.subject;
+    load (in, issue.assignedTo);
+    load (in, issue.author);
+    load (in, issue.category);
+    load (in, issue.priority);
+    load (in, issue.project);
+    load (in, issue.status);
+    load (in, issue.tracker);
+    load (in, issue.version);
+    in >> issue.dueDate >> issue.estimatedHours >> issue.startDate;
+    load (in, issue.customFields);
+}
+
+static void save (QDataStream& out, const Project& project)
+{
+    writeResource (out, project);
+    out << project._id << project._description << project._identifier << project._isPublic << project._name;
+    save (out, project._parent);
+    save (out, project._trackers);
+    save (out, project._categories);
+}
+
+static void load (QDataStream& in, Project& project)
+{
+    readResource (in, project);
+    in >> project._id >> project._description >> project._identifier >> project._isPublic >> project._name;
+    load (in, project._parent);
+    load (in, project._trackers);
+    load (in, project._categories);
+}
+
+static void save (QDataStream& out, const TimeEntry& timeEntry)
+{
+    writeResource (out, timeEntry);
+    out << timeEntry.id << timeEntry.comment << timeEntry.hours << timeEntry.spentOn;
+    save (out, timeEntry.activity);
+    save (out, timeEntry.issue);
+    save (out, timeEntry.project);
+    save (out, timeEntry.customFields);
+}
+
+static void load (QDataStream& in, TimeEntry& timeEntry)
+{
+    readResource (in, timeEntry);
+    in >> timeEntry.id >> timeEntry.comment >> timeEntry.hours >> timeEntry.spentOn;
+    load (in, timeEntry.activity);
+    load (in, timeEntry.issue);
+    load (in, timeEntry.project);
+    load (in, timeEntry.customFields);
+}
+
+static void save (QDataStream& out, const User& user)
+{
+    writeResource (out, user);
+    out << user._id << user._login << user._firstname << user._lastname << user._mail << user._lastLoginOn;
+}
+
+static void load (QDataStream& in, User& user)
+{
+    readResource (in, user);
+    in >> user._id >> user._login >> user._firstname >> user._lastname >> user._mail >> user._lastLoginOn;
+}
+
+static void save (QDataStream& out, const Tracker& tracker)
+{
+    writeResource (out, tracker);
+    out << tracker.id << tracker.name;
+}
+
+static void load (QDataStream& in, Tracker& tracker)
+{
+    readResource (in, tracker);
+    in >> tracker.id >> tracker.name;
+}
+
+static void save (QDataStream& out, const IssueStatus& status)
+{
+    writeResource (out, status);
+    out << status.id << status.name << status.isClosed << status.isDefault;
+}
+
+static void load (QDataStream& in, IssueStatus& status)
+{
+    readResource (in, status);
+    in >> status.id >> status.name >> status.isClosed >> status.isDefault;
+}
+
+static void save (QDataStream& out, const Enumeration& enumeration)
+{
+    writeResource (out, enumeration);
+    out << enumeration.id << enumeration.name << enumeration.isDefault;
+}
+
+static void load (QDataStream& in, Enumeration& enumeration)
+{
+    readResource (in, enumeration);
+    in >> enumeration.id >> enumeration.name >> enumeration.isDefault;
+}
+
+/**
+ * @brief Serialise a resource
+ *
+ * @param value Resource
+ *
+ * @return Serialised data
+ */
+template<typename T>
+static QByteArray pack (const T& value)
+{
+    QByteArray data;
+    QDataStream out (&data, QIODevice::WriteOnly);
+    out.setVersion (QDataStream::Qt_5_6);
+    save (out, value);
+    return data;
+}
+
+/**
+ * @brief Deserialise a resource
+ *
+ * @param data  Serialised data
+ * @param value Resource to fill
+ *
+ * @return true on success, false if the data is corrupt
+ */
+template<typename T>
+static bool unpack (const QByteArray& data, T& value)
+{
+    QDataStream in (data);
+    in.setVersion (QDataStream::Qt_5_6);
+    load (in, value);
+    return in.status () == QDataStream::Ok;
+}
+
+/// @}
+
+/**
+ * @brief Format a time as stored in indexed columns
+ *
+ * @param time Time
+ *
+ * @return Time in UTC, which sorts like the time itself; an empty string for an invalid time
+ */
+static QString
+storedTime (const QDateTime& time)
+{
+    return time.isValid () ? time.toUTC ().toString ("yyyy-MM-ddTHH:mm:ss'Z'") : QString ();
+}
+
+/**
+ * @brief Execute a prepared query and log errors
+ *
+ * @param query  Query
+ * @param method Calling method for the log
+ *
+ * @return true on success, false otherwise
+ */
+static bool
+exec (QSqlQuery& query, const char* method)
+{
+    if (query.exec ())
+        return true;
+
+    qWarning () << "[LocalStore]" << method << query.lastError ().text ();
+    return false;
+}
+
+/**
+ * @brief Run statements in a transaction, rolled back if one fails
+ *
+ * @param db     Database
+ * @param method Calling method for the log
+ * @param body   Statements, returning false on failure
+ *
+ * @return true on success, false otherwise
+ */
+template<typename Body>
+static bool
+transact (QSqlDatabase db, const char* method, Body body)
+{
+    if (!db.isOpen ())
+        return false;
+
+    if (!db.transaction ()) {
+        qWarning () << "[LocalStore]" << method << db.lastError ().text ();
+        return false;
+    }
+
+    if (!body () || !db.commit ()) {
+        qWarning () << "[LocalStore]" << method << "Rolling back:" << db.lastError ().text ();
+        db.rollback ();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Deserialise the first column of all result rows
+ *
+ * @param query  Prepared query
+ * @param method Calling method for the log
+ *
+ * @return Resources; corrupt rows are skipped
+ */
+template<typename T>
+static QVector<T>
+selectAll (QSqlQuery& query, const char* method)
+{
+    QVector<T> items;
+    if (!exec (query, method))
+        return items;
+
+    while (query.next ()) {
+        T item;
+        if (unpack (query.value (0).toByteArray (), item))
+            items.append (item);
+    }
+
+    return items;
+}
+
+LocalStore::LocalStore ()
+{
+    _instance = this;
+    _snapshotWriter.setMaxThreadCount (1);
+}
+
+LocalStore::~LocalStore ()
+{
+    close ();
+
+    if (_instance == this)
+        _instance = nullptr;
+}
+
+QString
+LocalStore::defaultFileName (const QString& url, const QString& user)
+{
+    QString root = QStandardPaths::writableLocation (QStandardPaths::AppDataLocation);
+
+    // One database per server and user
+    QByteArray partition = QCryptographicHash::hash ((url + " " + user).toUtf8 (),
+                                                     QCryptographicHash::Sha1).toHex ();
+    return QString ("%1/qtredmine/store/%2.sqlite").arg (root, QString (partition));
+}
+
+/// Snapshot file of a database file
+static QString snapshotFileName (const QString& fileName)
+{
+    return fileName + ".snapshot";
+}
+
+bool
+LocalStore::open (const QString& fileName)
+{
+    close ();
+
+    if (!QDir ().mkpath (QFileInfo (fileName).absolutePath ())) {
+        qWarning () << "[LocalStore][open] Cannot create the directory of" << fileName;
+        return false;
+    }
+
+    QString connection = QString ("qtredmine-store-%1").arg (nextConnection.fetchAndAddRelaxed (1));
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase ("QSQLITE", connection);
+        db.setDatabaseName (fileName);
+
+        if (!db.open ()) {
+            qWarning () << "[LocalStore][open]" << fileName << db.lastError ().text ();
+            db = QSqlDatabase ();
+            QSqlDatabase::removeDatabase (connection);
+            return false;
+        }
+    }
+
+    _connection = connection;
+    _modified = false;
+
+    if (!createSchema ()) {
+        close ();
+        return false;
+    }
+
+    // A missing or invalid snapshot is written by the next updateSnapshot()
+    if (!_snapshot.open (snapshotFileName (fileName)))
+        _modified = true;
+
+    return true;
+}
+
+void
+LocalStore::close ()
+{
+    if (_connection.isEmpty ())
+        return;
+
+    // Snapshot updates of this database are written before another one can be opened
+    _snapshot.close ();
+    _snapshotWriter.waitForDone ();
+    _modified = false;
+
+    // The connection can only be removed once no QSqlDatabase refers to it anymore
+    {
+        QSqlDatabase db = QSqlDatabase::database (_connection, false);
+        db.close ();
+    }
+
+    QSqlDatabase::removeDatabase (_connection);
+    _connection.clear ();
+}
+
+bool
+LocalStore::isOpen () const
+{
+    return !_connection.isEmpty () && QSqlDatabase::database (_connection, false).isOpen ();
+}
+
+QString
+LocalStore::fileName () const
+{
+    if (_connection.isEmpty ())
+        return QString ();
+
+    return QSqlDatabase::database (_connection, false).databaseName ();
+}
+
+const Snapshot&
+LocalStore::snapshot () const
+{
+    return _snapshot;
+}
+
+bool
+LocalStore::isSnapshotCurrent () const
+{
+    return _snapshot.isOpen () && !_modified;
+}
+
+/// Merge synchronised issues and projects into a snapshot file and replace it
+static void mergeSnapshot (const QString& fileName, Issues issues, Projects projects, bool complete)
+{
+    // Mapped once more, as the store's mapping must not be read on this thread
+    Snapshot current;
+    if (current.open (fileName)) {
+        QSet<int> ids;
+        for (const Issue &issue : issues)
+            ids.insert (issue.id);
+
+        for (int row = 0; row < current.issueCount (); ++row) {
+            IssueView issue = current.issue (row);
+            if (!ids.contains (issue.id ()))
+                issues.append (issue.toIssue ());
+        }
+
+        if (!complete) {
+            ids.clear ();
+            for (const Project &project : projects)
+                ids.insert (project._id);
+
+            for (int row = 0; row < current.projectCount (); ++row) {
+                ProjectView project = current.project (row);
+                if (!ids.contains (project.id ()))
+                    projects.append (project.toProject ());
+            }
+        }
+
+        current.close ();
+    }
+
+    // Same order as issues() and projects()
+    std::stable_sort (issues.begin (), issues.end (), [](const Issue& a, const Issue& b)
+    {
+        return a.updatedOn > b.updatedOn;
+    });
+    std::stable_sort (projects.begin (), projects.end (), [](const Project& a, const Project& b)
+    {
+        return a._name < b._name;
+    });
+
+    // Replacing the file leaves mappings of the previous one intact
+    if (!Snapshot::write (fileName, issues, projects))
+        qWarning () << "[LocalStore][updateSnapshot] Cannot write the snapshot" << fileName;
+}
+
+void
+LocalStore::updateSnapshot (const Issues& issues, const Projects& projects, bool complete)
+{
+    if (_connection.isEmpty () || (issues.isEmpty () && projects.isEmpty () && !complete))
+        return;
+
+    QtConcurrent::run (&_snapshotWriter, mergeSnapshot, snapshotFileName (fileName ()), issues, projects,
+                       complete);
+}
+
+bool
+LocalStore::createSchema ()
+{
+    QSqlDatabase db = QSqlDatabase::database (_connection, false);
+    QSqlQuery query (db);
+
+    // Readers do not block the writer, and a crash loses at most the last transaction
+    query.exec ("PRAGMA journal_mode=WAL");
+    query.exec ("PRAGMA synchronous=NORMAL");
+
+    int version = 0;
+    if (query.exec ("PRAGMA user_version") && query.next ())
+        version = query.value (0).toInt ();
+
+    return transact (db, "[createSchema]", [&]()
+    {
+        QStringList statements;
+
+        if (version != STORE_VERSION) {
+            statements << "DROP TABLE IF EXISTS issues"
+                       << "DROP TABLE IF EXISTS projects"
+                       << "DROP TABLE IF EXISTS time_entries"
+                       << "DROP TABLE IF EXISTS users"
+                       << "DROP TABLE IF EXISTS reference"
+                       << "DROP TABLE IF EXISTS sync_state"
+                       << "DROP TABLE IF EXISTS sync_issues"
+                       << QString ("PRAGMA user_version=%1").arg (STORE_VERSION);
+        }
+
+        statements << "CREATE TABLE IF NOT EXISTS issues (id INTEGER PRIMARY KEY, project_id INTEGER, "
+                      "status_id INTEGER, assigned_to_id INTEGER, updated_on TEXT, data BLOB)"
+                   << "CREATE INDEX IF NOT EXISTS issues_project ON issues (project_id)"
+                   << "CREATE INDEX IF NOT EXISTS issues_status ON issues (status_id)"
+                   << "CREATE INDEX IF NOT EXISTS issues_assigned_to ON issues (assigned_to_id)"
+                   << "CREATE INDEX IF NOT EXISTS issues_updated_on ON issues (updated_on)"
+                   << "CREATE TABLE IF NOT EXISTS projects (id INTEGER PRIMARY KEY, name TEXT, data BLOB)"
+                   << "CREATE TABLE IF NOT EXISTS time_entries (id INTEGER PRIMARY KEY, project_id INTEGER, "
+                      "spent_on TEXT, data BLOB)"
+                   << "CREATE INDEX IF NOT EXISTS time_entries_project ON time_entries (project_id)"
+                   << "CREATE TABLE IF NOT EXISTS users (id INTEGER PRIMARY KEY, data BLOB)"
+                   << "CREATE TABLE IF NOT EXISTS reference (kind TEXT, id INTEGER, data BLOB, "
+                      "PRIMARY KEY (kind, id))"
+                   << "CREATE TABLE IF NOT EXISTS sync_state (query TEXT PRIMARY KEY, cursor TEXT, "
+                      "newest TEXT, total_count INTEGER)"
+                   << "CREATE TABLE IF NOT EXISTS sync_issues (query TEXT, issue_id INTEGER, "
+                      "PRIMARY KEY (query, issue_id))";
+
+        for (const QString &statement : statements) {
+            if (!query.exec (statement)) {
+                qWarning () << "[LocalStore][createSchema]" << statement << query.lastError ().text ();
+                return false;
+            }
+        }
+
+        return true;
+    });
+}
+
+bool
+LocalStore::storeIssues (const Issues& issues)
+{
+    QSqlDatabase db = QSqlDatabase::database (_connection, false);
+    _modified = true;
+
+    return transact (db, "[storeIssues]", [&]()
+    {
+        QSqlQuery query (db);
+        query.prepare ("INSERT OR REPLACE INTO issues (id, project_id, status_id, assigned_to_id, updated_on, data) "
+                       "VALUES (?, ?, ?, ?, ?, ?)");
+
+        for (const Issue &issue : issues) {
+            query.addBindValue (issue.id);
+            query.addBindValue (issue.project._id);
+            query.addBindValue (issue.status._id);
+            query.addBindValue (issue.assignedTo._id);
+            query.addBindValue (storedTime (issue.updatedOn));
+            query.addBindValue (pack (issue));
+
+            if (!exec (query, "[storeIssues]"))
+                return false;
+        }
+
+        return true;
+    });
+}
+
+Issues
+LocalStore::issues (const IssueFilter& filter) const
+{
+    QSqlDatabase db = QSqlDatabase::database (_connection, false);
+    if (!db.isOpen ())
+        return Issues ();
+
+    QStringList conditions;
+    if (filter.projectId != NULL_ID)
+        conditions << "project_id = :project";
+    if (filter.statusId != NULL_ID)
+        conditions << "status_id = :status";
+    if (filter.assignedToId != NULL_ID)
+        conditions << "assigned_to_id = :assignedTo";
+    if (filter.updatedSince.isValid ())
+        conditions << "updated_on >= :updatedSince";
+
+    QString sql = "SELECT data FROM issues";
+    if (!conditions.isEmpty ())
+        sql += " WHERE " + conditions.join (" AND ");
+    sql += " ORDER BY updated_on DESC";
+
+    QSqlQuery query (db);
+    query.prepare (sql);
+    if (filter.projectId != NULL_ID)
+        query.bindValue (":project", filter.projectId);
+    if (filter.statusId != NULL_ID)
+        query.bindValue (":status", filter.statusId);
+    if (filter.assignedToId != NULL_ID)
+        query.bindValue (":assignedTo", filter.assignedToId);
+    if (filter.updatedSince.isValid ())
+        query.bindValue (":updatedSince", storedTime (filter.updatedSince));
+
+    return selectAll<Issue> (query, "[issues]");
+}
+
+bool
+LocalStore::storeProjects (const Projects& projects, bool complete)
+{
+    QSqlDatabase db = QSqlDatabase::database (_connection, false);
+    _modified = true;
+
+    return transact (db, "[storeProjects]", [&]()
+    {
+        QSqlQuery query (db);
+
+        if (complete && !query.exec ("DELETE FROM projects")) {
+            qWarning () << "[LocalStore][storeProjects]" << query.lastError ().text ();
+            return false;
+        }
+
+        query.prepare ("INSERT OR REPLACE INTO projects (id, name, data) VALUES (?, ?, ?)");
+
+        for (const Project &project : projects) {
+            query.addBindValue (project._id);
+            query.addBindValue (project._name);
+            query.addBindValue (pack (project));
+
+            if (!exec (query, "[storeProjects]"))
+                return false;
+        }
+
+        return true;
+    });
+}
+
+Projects
+LocalStore::projects () const
+{
+    QSqlDatabase db = QSqlDatabase::database (_connection, false);
+    if (!db.isOpen ())
+        return Projects ();
+
+    QSqlQuery query (db);
+    query.prepare ("SELECT data FROM projects ORDER BY name");
+    return selectAll<Project> (query, "[projects]");
+}
+
+bool
+LocalStore::storeTimeEntries (const TimeEntries& timeEntries)
+{
+    QSqlDatabase db = QSqlDatabase::database (_connection, false);
+
+    return transact (db, "[storeTimeEntries]", [&]()
+    {
+        QSqlQuery query (db);
+        query.prepare ("INSERT OR REPLACE INTO time_entries (id, project_id, spent_on, data) VALUES (?, ?, ?, ?)");
+
+        for (const TimeEntry &timeEntry : timeEntries) {
+            query.addBindValue (timeEntry.id);
+            query.addBindValue (timeEntry.project._id);
+            query.addBindValue (timeEntry.spentOn.toString (Qt::ISODate));
+            query.addBindValue (pack (timeEntry));
+
+            if (!exec (query, "[storeTimeEntries]"))
+                return false;
+        }
+
+        return true;
+    });
+}
+
+TimeEntries
+LocalStore::timeEntries (int projectId) const
+{
+    QSqlDatabase db = QSqlDatabase::database (_connection, false);
+    if (!db.isOpen ())
+        return TimeEntries ();
+
+    QSqlQuery query (db);
+    if (projectId == NULL_ID) {
+        query.prepare ("SELECT data FROM time_entries ORDER BY spent_on DESC");
+    } else {
+        query.prepare ("SELECT data FROM time_entries WHERE project_id = ? ORDER BY spent_on DESC");
+        query.addBindValue (projectId);
+    }
+
+    return selectAll<TimeEntry> (query, "[timeEntries]");
+}
+
+bool
+LocalStore::storeUsers (const Users& users)
+{
+    QSqlDatabase db = QSqlDatabase::database (_connection, false);
+
+    return transact (db, "[storeUsers]", [&]()
+    {
+        QSqlQuery query (db);
+        query.prepare ("INSERT OR REPLACE INTO users (id, data) VALUES (?, ?)");
+
+        for (const User &user : users) {
+            query.addBindValue (user._id);
+            query.addBindValue (pack (user));
+
+            if (!exec (query, "[storeUsers]"))
+                return false;
+        }
+
+        return true;
+    });
+}
+
+Users
+LocalStore::users () const
+{
+    QSqlDatabase db = QSqlDatabase::database (_connection, false);
+    if (!db.isOpen ())
+        return Users ();
+
+    QSqlQuery query (db);
+    query.prepare ("SELECT data FROM users ORDER BY id");
+    return selectAll<User> (query, "[users]");
+}
+
+bool
+LocalStore::storeCurrentUser (const User& user)
+{
+    return storeReference ("current_user", {qMakePair (user._id, pack (user))});
+}
+
+User
+LocalStore::currentUser () const
+{
+    User user;
+    QVector<QByteArray> data = reference ("current_user");
+    if (!data.isEmpty ())
+        unpack (data.first (), user);
+
+    return user;
+}
+
+bool
+LocalStore::storeReference (const QString& kind, const QVector<QPair<int, QByteArray>>& items)
+{
+    QSqlDatabase db = QSqlDatabase::database (_connection, false);
+
+    return transact (db, "[storeReference]", [&]()
+    {
+        QSqlQuery query (db);
+        query.prepare ("DELETE FROM reference WHERE kind = ?");
+        query.addBindValue (kind);
+        if (!exec (query, "[storeReference]"))
+            return false;
+
+        query.prepare ("INSERT INTO reference (kind, id, data) VALUES (?, ?, ?)");
+        for (const auto &item : items) {
+            query.addBindValue (kind);
+            query.addBindValue (item.first);
+            query.addBindValue (item.second);
+
+            if (!exec (query, "[storeReference]"))
+                return false;
+        }
+
+        return true;
+    });
+}
+
+QVector<QByteArray>
+LocalStore::reference (const QString& kind) const
+{
+    QVector<QByteArray> data;
+
+    QSqlDatabase db = QSqlDatabase::database (_connection, false);
+    if (!db.isOpen ())
+        return data;
+
+    QSqlQuery query (db);
+    query.prepare ("SELECT data FROM reference WHERE kind = ? ORDER BY id");
+    query.addBindValue (kind);
+    if (!exec (query, "[reference]"))
+        return data;
+
+    while (query.next ())
+        data.append (query.value (0).toByteArray ());
+
+    return data;
+}
+
+/**
+ * @brief Serialise reference data for LocalStore::storeReference()
+ *
+ * @param items Resources with an \c id member
+ *
+ * @return Resource IDs and their serialised data
+ */
+template<typename T>
+static QVector<QPair<int, QByteArray>>
+packReference (const QVector<T>& items)
+{
+    QVector<QPair<int, QByteArray>> packed;
+    for (const T &item : items)
+        packed.append (qMakePair (item.id, pack (item)));
+
+    return packed;
+}
+
+/**
+ * @brief Deserialise reference data from LocalStore::reference()
+ *
+ * @param data Serialised data
+ *
+ * @return Resources; corrupt ones are skipped
+ */
+template<typename T>
+static QVector<T>
+unpackReference (const QVector<QByteArray>& data)
+{
+    QVector<T> items;
+    for (const QByteArray &bytes : data) {
+        T item;
+        if (unpack (bytes, item))
+            items.append (item);
+    }
+
+    return items;
+}
+
+bool
+LocalStore::storeTrackers (const Trackers& trackers)
+{
+    return storeReference ("trackers", packReference (trackers));
+}
+
+Trackers
+LocalStore::trackers () const
+{
+    return unpackReference<Tracker> (reference ("trackers"));
+}
+
+bool
+LocalStore::storeIssueStatuses (const IssueStatuses& issueStatuses)
+{
+    return storeReference ("issue_statuses", packReference (issueStatuses));
+}
+
+IssueStatuses
+LocalStore::issueStatuses () const
+{
+    return unpackReference<IssueStatus> (reference ("issue_statuses"));
+}
+
+bool
+LocalStore::storeIssuePriorities (const Enumerations& issuePriorities)
+{
+    return storeReference ("issue_priorities", packReference (issuePriorities));
+}
+
+Enumerations
+LocalStore::issuePriorities () const
+{
+    return unpackReference<Enumeration> (reference ("issue_priorities"));
+}
+
+bool
+LocalStore::storeTimeEntryActivities (const Enumerations& timeEntryActivities)
+{
+    return storeReference ("time_entry_activities", packReference (timeEntryActivities));
+}
+
+Enumerations
+LocalStore::timeEntryActivities () const
+{
+    return unpackReference<Enumeration> (reference ("time_entry_activities"));
+}
+
+bool
+LocalStore::storeCustomFields (const CustomFields& customFields)
+{
+    return storeReference ("custom_fields", packReference (customFields));
+}
+
+CustomFields
+LocalStore::customFields () const
+{
+    return unpackReference<CustomField> (reference ("custom_fields"));
+}
+
+bool
+LocalStore::storeSyncState (const QString& query, const QDateTime& cursor, const ListFingerprint& fingerprint,
+                            const QVector<int>& issueIds)
+{
+    QSqlDatabase db = QSqlDatabase::database (_connection, false);
+
+    return transact (db, "[storeSyncState]", [&]()
+    {
+        QSqlQuery sql (db);
+        sql.prepare ("INSERT OR REPLACE INTO sync_state (query, cursor, newest, total_count) VALUES (?, ?, ?, ?)");
+        sql.addBindValue (query);
+        sql.addBindValue (storedTime (cursor));
+        sql.addBindValue (storedTime (fingerprint.newest));
+        sql.addBindValue (fingerprint.totalCount);
+        if (!exec (sql, "[storeSyncState]"))
+            return false;
+
+        sql.prepare ("INSERT OR IGNORE INTO sync_issues (query, issue_id) VALUES (?, ?)");
+        for (int id : issueIds) {
+            sql.addBindValue (query);
+            sql.addBindValue (id);
+
+            if (!exec (sql, "[storeSyncState]"))
+                return false;
+        }
+
+        return true;
+    });
+}
+
+bool
+LocalStore::syncState (const QString& query, QDateTime& cursor, ListFingerprint& fingerprint, Issues& issues) const
+{
+    QSqlDatabase db = QSqlDatabase::database (_connection, false);
+    if (!db.isOpen ())
+        return false;
+
+    QSqlQuery sql (db);
+    sql.prepare ("SELECT cursor, newest, total_count FROM sync_state WHERE query = ?");
+    sql.addBindValue (query);
+    if (!exec (sql, "[syncState]") || !sql.next ())
+        return false;
+
+    cursor = QDateTime::fromString (sql.value (0).toString (), Qt::ISODate);
+    fingerprint.newest = QDateTime::fromString (sql.value (1).toString (), Qt::ISODate);
+    fingerprint.totalCount = sql.value (2).toInt ();
+
+    sql.prepare ("SELECT issues.data FROM sync_issues JOIN issues ON issues.id = sync_issues.issue_id "
+                 "WHERE sync_issues.query = ?");
+    sql.addBindValue (query);
+    issues = selectAll<Issue> (sql, "[syncState]");
+
+    return true;
+}
+
+bool
+LocalStore::removeSyncState (const QString& query)
+{
+    QSqlDatabase db = QSqlDatabase::database (_connection, false);
+
+    return transact (db, "[removeSyncState]", [&]()
+    {
+        QSqlQuery sql (db);
+        sql.prepare ("DELETE FROM sync_state WHERE query = ?");
+        sql.addBindValue (query);
+        if (!exec (sql, "[removeSyncState]"))
+            return false;
+
+        sql.prepare ("DELETE FROM sync_issues WHERE query = ?");
+        sql.addBindValue (query);
+        return exec (sql, "[removeSyncState]");
+    });
+}
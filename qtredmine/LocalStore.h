@@ -0,0 +1,263 @@
+#ifndef LOCAL_STORE_H
+#define LOCAL_STORE_H
+
+#include "SimpleRedmineTypes.h"
+#include "Snapshot.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QPair>
+#include <QtCore/QString>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+
+namespace qtredmine {
+
+//!
+//! @brief Persistent local copy of Redmine resources
+//!
+//! Issues, projects, time entries, users and reference data are kept in an SQLite database, so the
+//! last known state can be shown right after startup and while Redmine is not accessible. Issues are
+//! indexed by project, status, assignee and update time.
+//!
+//! The resources are stored in the format of this class's version; a database written by another
+//! version is emptied when it is opened. Every store method writes in a single transaction.
+//!
+//! After a sync, updateSnapshot() writes the synchronised issues and projects to a snapshot next to
+//! the database, on a worker thread. The next open() maps it, so the last state can be shown without
+//! querying and decoding the database.
+//!
+//! A store has to be used on the thread that opened it.
+//!
+class LocalStore
+{
+public:
+    static LocalStore *_instance;
+
+    /// Issue selection, unset members match all issues
+    struct IssueFilter
+    {
+        int       projectId    = NULL_ID; ///< Project
+        int       statusId     = NULL_ID; ///< Issue status
+        int       assignedToId = NULL_ID; ///< Assigned user or group
+        QDateTime updatedSince;           ///< Earliest update time
+    };
+
+    //! @brief Constructor for a closed store; the latest store becomes the instance
+    LocalStore ();
+
+    //! @brief Destructor; closes the database
+    ~LocalStore ();
+
+    //! @brief Get the default database file of a Redmine server and user
+    //!
+    //! @param url  Redmine URL
+    //! @param user Login name
+    //!
+    //! @return Database file name below the application data location
+    static QString defaultFileName (const QString& url, const QString& user);
+
+    //! @brief Open a database, closing the current one
+    //! @param fileName Database file name; missing directories are created
+    //! @return true on success, false otherwise
+    bool open (const QString& fileName);
+
+    //! @brief Close the database, waiting for snapshot updates that are still being written
+    void close ();
+
+    //! @brief Check whether a database is open
+    //! @return true if a database is open, false otherwise
+    bool isOpen () const;
+
+    //! @brief Get the file name of the open database
+    //! @return File name, empty while closed
+    QString fileName () const;
+
+    //! @brief Get the snapshot mapped when the database was opened
+    //! @return Snapshot, not open if there was none or it was invalid
+    const Snapshot& snapshot () const;
+
+    //! @brief Check whether the snapshot still matches the stored issues and projects
+    //! @return true if the snapshot is open and nothing has been stored since, false otherwise
+    bool isSnapshotCurrent () const;
+
+    //! @brief Update the snapshot file in the background, after a sync has stored its results
+    //!
+    //! The issues and projects replace those of the snapshot file with the same IDs, the others are
+    //! kept; the database is not read. The mapped snapshot stays as it is until the next open().
+    //!
+    //! @param issues   Issues the sync has stored
+    //! @param projects Projects the sync has stored
+    //! @param complete \c projects are all projects, other ones are removed from the snapshot
+    void updateSnapshot (const Issues& issues, const Projects& projects = Projects (), bool complete = false);
+
+    /// @name Issues
+    /// @{
+
+    //! @brief Insert or update issues
+    //! @param issues Issues
+    //! @return true on success, false otherwise
+    bool storeIssues (const Issues& issues);
+
+    //! @brief Get stored issues
+    //! @param filter Issue selection
+    //! @return Issues, most recently updated first
+    Issues issues (const IssueFilter& filter = IssueFilter ()) const;
+
+    /// @}
+
+    /// @name Projects
+    /// @{
+
+    //! @brief Insert or update projects
+    //!
+    //! @param projects Projects
+    //! @param complete \c projects are all projects, other stored ones are removed
+    //!
+    //! @return true on success, false otherwise
+    bool storeProjects (const Projects& projects, bool complete = false);
+
+    //! @brief Get stored projects
+    //! @return Projects ordered by name
+    Projects projects () const;
+
+    /// @}
+
+    /// @name Time entries
+    /// @{
+
+    //! @brief Insert or update time entries
+    //! @param timeEntries Time entries
+    //! @return true on success, false otherwise
+    bool storeTimeEntries (const TimeEntries& timeEntries);
+
+    //! @brief Get stored time entries
+    //! @param projectId Project, NULL_ID for all projects
+    //! @return Time entries, most recently spent first
+    TimeEntries timeEntries (int projectId = NULL_ID) const;
+
+    /// @}
+
+    /// @name Users
+    /// @{
+
+    //! @brief Insert or update users
+    //! @param users Users
+    //! @return true on success, false otherwise
+    bool storeUsers (const Users& users);
+
+    //! @brief Get stored users
+    //! @return Users ordered by ID
+    Users users () const;
+
+    //! @brief Store the authenticated user
+    //! @param user User
+    //! @return true on success, false otherwise
+    bool storeCurrentUser (const User& user);
+
+    //! @brief Get the stored authenticated user
+    //! @return User, or one with ID -1 if none has been stored
+    User currentUser () const;
+
+    /// @}
+
+    /// @name Reference data
+    /// Every store method replaces all stored resources of its kind and returns false on failure.
+    /// @{
+
+    //! @brief Store all trackers
+    bool storeTrackers (const Trackers& trackers);
+
+    //! @brief Get the stored trackers
+    Trackers trackers () const;
+
+    //! @brief Store all issue statuses
+    bool storeIssueStatuses (const IssueStatuses& issueStatuses);
+
+    //! @brief Get the stored issue statuses
+    IssueStatuses issueStatuses () const;
+
+    //! @brief Store all issue priorities
+    bool storeIssuePriorities (const Enumerations& issuePriorities);
+
+    //! @brief Get the stored issue priorities
+    Enumerations issuePriorities () const;
+
+    //! @brief Store all time entry activities
+    bool storeTimeEntryActivities (const Enumerations& timeEntryActivities);
+
+    //! @brief Get the stored time entry activities
+    Enumerations timeEntryActivities () const;
+
+    //! @brief Store all custom fields
+    bool storeCustomFields (const CustomFields& customFields);
+
+    //! @brief Get the stored custom fields
+    CustomFields customFields () const;
+
+    /// @}
+
+    /// @name Synchronisation state
+    /// @{
+
+    //! @brief Store the state of a synchronised query
+    //!
+    //! @param query       Canonical query string
+    //! @param cursor      High-water mark of the query
+    //! @param fingerprint Probe result of the last sync
+    //! @param issueIds    IDs of issues that match the query, added to the stored ones
+    //!
+    //! @return true on success, false otherwise
+    bool storeSyncState (const QString& query, const QDateTime& cursor, const ListFingerprint& fingerprint,
+                         const QVector<int>& issueIds);
+
+    //! @brief Get the state of a synchronised query
+    //!
+    //! @param query       Canonical query string
+    //! @param cursor      High-water mark to fill
+    //! @param fingerprint Probe result to fill
+    //! @param issues      Issues of the query to fill
+    //!
+    //! @return true if the query has been synchronised before, false otherwise
+    bool syncState (const QString& query, QDateTime& cursor, ListFingerprint& fingerprint, Issues& issues) const;
+
+    //! @brief Remove the state of a synchronised query; its issues are kept
+    //! @param query Canonical query string
+    //! @return true on success, false otherwise
+    bool removeSyncState (const QString& query);
+
+    /// @}
+
+private:
+    //! @brief Create the tables, or empty them if they were written by another format version
+    //! @return true on success, false otherwise
+    bool createSchema ();
+
+    //! @brief Replace all reference data of a kind
+    //!
+    //! @param kind  Kind of reference data
+    //! @param items Resource IDs and their serialised data
+    //!
+    //! @return true on success, false otherwise
+    bool storeReference (const QString& kind, const QVector<QPair<int, QByteArray>>& items);
+
+    //! @brief Get the serialised reference data of a kind
+    //! @param kind Kind of reference data
+    //! @return Serialised data ordered by ID
+    QVector<QByteArray> reference (const QString& kind) const;
+
+    /// Name of the database connection, empty while closed
+    QString _connection;
+
+    /// Snapshot of the issues and projects as of opening the database
+    Snapshot _snapshot;
+
+    /// Issues or projects have been stored since opening the database
+    bool _modified {false};
+
+    /// Single thread writing snapshot updates, so that each builds on the previous one
+    QThreadPool _snapshotWriter;
+};
+
+} // qtredmine
+
+#endif // LOCAL_STORE_H
@@ -1,7 +1,8 @@
 #include "Logging.h"
 
-static int __debug_indent__ = 0;
-static bool __debug_newline__ = false;
+// Per thread, since resources are also decoded on worker threads
+static thread_local int __debug_indent__ = 0;
+static thread_local bool __debug_newline__ = false;
 
 int
 getLoggingIndent()
@@ -3,12 +3,119 @@
 #include "PasswordAuthenticator.h"
 #include "RedmineClient.h"
 
+#include <QCryptographicHash>
+#include <QFutureWatcher>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QLocale>
+#include <QNetworkCookieJar>
 #include <QNetworkRequest>
+#include <QRandomGenerator>
+#include <QSslConfiguration>
+#include <QStandardPaths>
+#include <QThread>
+#include <QThreadStorage>
+#include <QTimer>
+#include <QUrlQuery>
+#include <QtConcurrentRun>
+
+#include <algorithm>
 
 using namespace qtredmine;
 
+/// Reply property set when a request has been aborted by its deadline
+static const char* TIMED_OUT_PROPERTY = "qtredmine_timedOut";
+
+/// Maximum number of requests running at once on a multiplexed HTTP/2 connection
+static const int MAX_HTTP2_STREAMS = 32;
+
+/// Longest \c Retry-After delay in milliseconds that is waited for instead of failing
+static const qint64 MAX_RETRY_AFTER = 2 * 60 * 1000;
+
+namespace {
+
+//!
+//! @brief Finished copy of a network reply
+//!
+//! Callbacks on other threads than the client's receive a copy with the status, headers and
+//! properties of the reply, since the reply itself is deleted once the client's thread has moved on.
+//!
+class DetachedReply : public QNetworkReply
+{
+public:
+    explicit DetachedReply (const QNetworkReply* reply)
+    {
+        setUrl (reply->url ());
+        setOperation (reply->operation ());
+        setRequest (reply->request ());
+        setError (reply->error (), reply->errorString ());
+
+        for (QNetworkRequest::Attribute attribute : {QNetworkRequest::HttpStatusCodeAttribute,
+                                                     QNetworkRequest::HttpReasonPhraseAttribute,
+                                                     QNetworkRequest::RedirectionTargetAttribute,
+                                                     QNetworkRequest::SourceIsFromCacheAttribute,
+                                                     QNetworkRequest::HttpPipeliningWasUsedAttribute,
+                                                     QNetworkRequest::Http2WasUsedAttribute})
+            setAttribute (attribute, reply->attribute (attribute));
+
+        for (const QNetworkReply::RawHeaderPair &header : reply->rawHeaderPairs ())
+            setRawHeader (header.first, header.second);
+
+        // E.g. the timeout marker
+        for (const QByteArray &name : reply->dynamicPropertyNames ())
+            setProperty (name.constData (), reply->property (name.constData ()));
+
+        open (QIODevice::ReadOnly);
+        setFinished (true);
+    }
+
+    void abort () override {}
+
+protected:
+    qint64 readData (char*, qint64) override { return -1; }
+};
+
+//!
+//! @brief Failed reply of a request that the client rejected
+//!
+//! Reported to the callback when a request from another thread cannot be queued, since the caller
+//! has already been given a handle.
+//!
+class RejectedReply : public QNetworkReply
+{
+public:
+    RejectedReply ()
+    {
+        setOperation (QNetworkAccessManager::UnknownOperation);
+        setError (QNetworkReply::ProtocolFailure, "Request rejected by the client");
+        open (QIODevice::ReadOnly);
+        setFinished (true);
+    }
+
+    void abort () override {}
+
+protected:
+    qint64 readData (char*, qint64) override { return -1; }
+};
+
+} // namespace
+
+/**
+ * @brief Get an object living in the calling thread, to queue callbacks to that thread
+ *
+ * @return Context object, deleted when the thread finishes
+ */
+static QObject*
+threadContext ()
+{
+    static QThreadStorage<QObject*> contexts;
+
+    if (!contexts.hasLocalData ())
+        contexts.setLocalData (new QObject ());
+
+    return contexts.localData ();
+}
+
 RedmineClient::RedmineClient( QObject* parent )
     : QObject( parent )
 {
@@ -16,6 +123,25 @@ RedmineClient::RedmineClient( QObject* parent )
     RETURN();
 }
 
+RedmineClient::~RedmineClient()
+{
+    ENTER();
+
+    if( _networkThread )
+    {
+        // The children, e.g. the network manager and running replies, belong to the network thread;
+        // they are brought back to be destroyed on the deleting thread
+        QThread *owner = QThread::currentThread ();
+        if( owner != _networkThread )
+            QMetaObject::invokeMethod( this, [this, owner]() { moveToThread( owner ); },
+                                       Qt::BlockingQueuedConnection );
+
+        stopNetworkThread();
+    }
+
+    RETURN();
+}
+
 RedmineClient::RedmineClient( const QString& url, QObject* parent )
     : RedmineClient( parent )
 {
@@ -57,7 +183,12 @@ RedmineClient::init()
 {
     ENTER();
 
-    reconnect();
+    // Keep the network access manager, and with it any open or pre-warmed connection
+    if( _nma )
+        _nma->setCookieJar( new QNetworkCookieJar( _nma ) );
+    else
+        reconnect();
+
     emit initialised();
 
     RETURN();
@@ -68,10 +199,42 @@ RedmineClient::reconnect()
 {
     ENTER();
 
+    if( forwardToClientThread( [=]() { reconnect(); } ) )
+        RETURN();
+
     // Possibly delete old QNetworkAccessManager object
     if( _nma )
+    {
+        disconnect( _nma, nullptr, this, nullptr );
         _nma->deleteLater();
 
+        // Running GET requests are sent again on the new connection, others are dropped
+        for( PendingRequest* pending : callbacks_ )
+        {
+            if( pending->mode == QNetworkAccessManager::GetOperation )
+            {
+                if( pending->reader )
+                {
+                    QSharedPointer<JsonStreamReader> reader = pending->reader;
+                    queueDecoding( pending, [reader]() { reader->restart(); } );
+                    pending->received.clear();
+                }
+
+                pending->reply = nullptr;
+                _queues[int (pending->priority)].prepend( pending );
+            }
+            else
+            {
+                qWarning() << "[RedmineClient][reconnect] Dropping request" << pending->request.url();
+                releaseRequest( pending );
+            }
+        }
+
+        callbacks_.clear();
+        _runningPerHost.clear();
+        _preconnectedOrigin.clear();
+    }
+
     // Create QNetworkAccessManager object
     _nma = new QNetworkAccessManager( this );
 
@@ -90,6 +253,51 @@ RedmineClient::reconnect()
         RETURN();
     } );
 
+    dispatchRequests();
+
+    RETURN();
+}
+
+void
+RedmineClient::preconnect( const QString& target )
+{
+    ENTER()(target);
+
+    if( forwardToClientThread( [=]() { preconnect( target ); } ) )
+        RETURN();
+
+    QUrl url( target.isEmpty() ? _url : target );
+    if( !url.isValid() || url.host().isEmpty() )
+        RETURN();
+
+    if( !_nma )
+        reconnect();
+
+    QString origin = QString( "%1://%2:%3" ).arg( url.scheme() ).arg( url.host() )
+                                             .arg( url.port( url.scheme() == "https" ? 443 : 80 ) );
+
+    if( origin == _preconnectedOrigin && _preconnectedOn.secsTo( QDateTime::currentDateTimeUtc() ) < 30 )
+        RETURN();
+
+    _preconnectedOrigin = origin;
+    _preconnectedOn = QDateTime::currentDateTimeUtc();
+
+    DEBUG() << "Pre-connecting to" << origin;
+
+    if( url.scheme() == "https" )
+    {
+        QSslConfiguration ssl = QSslConfiguration::defaultConfiguration();
+
+        // Offer the same protocols as the requests will, so that they can use this connection
+        if( _transportMode == TransportMode::Multiplexed )
+            ssl.setAllowedNextProtocols( { QSslConfiguration::ALPNProtocolHTTP2,
+                                           QSslConfiguration::NextProtocolHttp1_1 } );
+
+        _nma->connectToHostEncrypted( url.host(), quint16( url.port( 443 ) ), ssl );
+    }
+    else
+        _nma->connectToHost( url.host(), quint16( url.port( 80 ) ) );
+
     RETURN();
 }
 
@@ -97,6 +305,10 @@ QString
 RedmineClient::getUrl() const
 {
     ENTER();
+
+    // Other threads read it directly instead of waiting for the client's thread
+    QMutexLocker locker( &_stateMutex );
+
     RETURN( _url );
 }
 
@@ -116,12 +328,17 @@ RedmineClient::setAuthenticator( const QString& apiKey )
 {
     ENTER()(apiKey);
 
+    if( forwardToClientThread( [=]() { setAuthenticator( apiKey ); } ) )
+        RETURN();
+
     if( apiKey == authApiKey_ )
         RETURN();
 
     authApiKey_ = apiKey;
 
     auth_ = new KeyAuthenticator( apiKey.toLatin1(), this );
+    updateDiskCacheDirectory();
+    emit identityChanged();
 
     if( !_url.isEmpty() )
         init();
@@ -134,6 +351,9 @@ RedmineClient::setAuthenticator( const QString& login, const QString& password )
 {
     ENTER()(login)(password);
 
+    if( forwardToClientThread( [=]() { setAuthenticator( login, password ); } ) )
+        RETURN();
+
     if( login == authLogin_ && password == authPassword_ )
         RETURN();
 
@@ -141,6 +361,8 @@ RedmineClient::setAuthenticator( const QString& login, const QString& password )
     authPassword_ = password;
 
     auth_ = new PasswordAuthenticator( login, password, this );
+    updateDiskCacheDirectory();
+    emit identityChanged();
 
     if( !_url.isEmpty() )
         init();
@@ -153,6 +375,9 @@ RedmineClient::setCheckSsl(bool checkSsl )
 {
     ENTER()(checkSsl);
 
+    if( forwardToClientThread( [=]() { setCheckSsl( checkSsl ); } ) )
+        RETURN();
+
     if( checkSsl == checkSsl_ )
         RETURN();
 
@@ -169,47 +394,401 @@ RedmineClient::setUrl( const QString& url )
 {
     ENTER()(url);
 
+    if( forwardToClientThread( [=]() { setUrl( url ); } ) )
+        RETURN();
+
     if( url == _url )
         RETURN();
 
-    _url = url;
+    {
+        QMutexLocker locker( &_stateMutex );
+        _url = url;
+    }
+
+    updateDiskCacheDirectory();
+    emit identityChanged();
 
     if( auth_ )
         init();
 
+    preconnect();
+
     RETURN();
 }
 
+void
+RedmineClient::setConditionalRequests (bool enabled)
+{
+    if (forwardToClientThread ([=]() { setConditionalRequests (enabled); } ))
+        return;
+
+    _conditionalRequests = enabled;
+
+    if (!enabled)
+        _validators.clear ();
+}
+
+QString
+RedmineClient::authIdentity () const
+{
+    if (!auth_)
+        return QString ();
+
+    // The password is part of the identity, so a changed password does not see the old responses
+    QByteArray identity = authApiKey_.isEmpty () ? (authLogin_ + ":" + authPassword_).toUtf8 ()
+                                                 : authApiKey_.toUtf8 ();
+    return QCryptographicHash::hash (identity, QCryptographicHash::Sha1).toHex ();
+}
+
+QString
+RedmineClient::cacheKey (const QUrl& url) const
+{
+    auto items = QUrlQuery (url).queryItems (QUrl::FullyEncoded);
+
+    // Query strings are assembled with leading '&' and in arbitrary order
+    items.erase (std::remove_if (items.begin (), items.end (),
+                                 [](const QPair<QString, QString> &item) { return item.first.isEmpty (); }),
+                 items.end ());
+    std::sort (items.begin (), items.end ());
+
+    QUrlQuery query;
+    query.setQueryItems (items);
+
+    QUrl canonical (url);
+    canonical.setQuery (query);
+
+    return authIdentity () + " " + canonical.toString (QUrl::FullyEncoded);
+}
+
+void
+RedmineClient::setDiskCacheEnabled (bool enabled)
+{
+    if (forwardToClientThread ([=]() { setDiskCacheEnabled (enabled); } ))
+        return;
+
+    _diskCacheEnabled = enabled;
+    updateDiskCacheDirectory ();
+}
+
+void
+RedmineClient::setCachePolicy (const QString& resource, int ttlSeconds)
+{
+    if (forwardToClientThread ([=]() { setCachePolicy (resource, ttlSeconds); } ))
+        return;
+
+    if (ttlSeconds > 0)
+        _cachePolicies[resource] = ttlSeconds;
+    else
+        _cachePolicies.remove (resource);
+}
+
+void
+RedmineClient::setDiskCacheSize (qint64 bytes)
+{
+    if (forwardToClientThread ([=]() { setDiskCacheSize (bytes); } ))
+        return;
+
+    _diskCache.setMaximumSize (bytes);
+}
+
+void
+RedmineClient::updateDiskCacheDirectory ()
+{
+    QString root = QStandardPaths::writableLocation (QStandardPaths::CacheLocation);
+
+    if (!_diskCacheEnabled || !auth_ || _url.isEmpty () || root.isEmpty ()) {
+        _diskCache.setDirectory (QString ());
+        return;
+    }
+
+    // One directory per server and user, below a format version
+    QByteArray partition = QCryptographicHash::hash ((_url + " " + authIdentity ()).toUtf8 (),
+                                                     QCryptographicHash::Sha1).toHex ();
+    _diskCache.setDirectory (QString ("%1/qtredmine/v1/%2").arg (root, QString (partition)));
+}
+
+void
+RedmineClient::setMaxRequestsPerHost (int maxRequests)
+{
+    if (forwardToClientThread ([=]() { setMaxRequestsPerHost (maxRequests); } ))
+        return;
+
+    _maxRequestsPerHost = qMax (1, maxRequests);
+    dispatchRequests ();
+}
+
+void
+RedmineClient::setRequestTimeout (int msecs)
+{
+    if (forwardToClientThread ([=]() { setRequestTimeout (msecs); } ))
+        return;
+
+    _requestTimeout = qMax (0, msecs);
+}
+
+void
+RedmineClient::setRetryPolicy (int maxRetries, int baseDelayMsecs, int maxDelayMsecs)
+{
+    if (forwardToClientThread ([=]() { setRetryPolicy (maxRetries, baseDelayMsecs, maxDelayMsecs); } ))
+        return;
+
+    _maxRetries = qMax (0, maxRetries);
+    _retryBaseDelay = qMax (1, baseDelayMsecs);
+    _retryMaxDelay = qMax (_retryBaseDelay, maxDelayMsecs);
+}
+
+bool
+RedmineClient::isTimedOut (const QNetworkReply* reply)
+{
+    return reply && reply->property (TIMED_OUT_PROPERTY).toBool ();
+}
+
+void
+RedmineClient::setTransportMode (TransportMode mode)
+{
+    if (forwardToClientThread ([=]() { setTransportMode (mode); } ))
+        return;
+
+    _transportMode = mode;
+
+    QMutexLocker locker (&_stateMutex);
+    _protocols.clear ();
+}
+
+void
+RedmineClient::setThreadMode (ThreadMode mode)
+{
+    bool networkThread = mode == ThreadMode::NetworkThread;
+    if (networkThread == (_networkThread != nullptr))
+        return;
+
+    if (networkThread)
+    {
+        if (QThread::currentThread () != thread () || parent ()) {
+            qCritical () << "[RedmineClient][setThreadMode] Only a client without parent can move, from its own thread";
+            return;
+        }
+
+        _networkThread = new QThread ();
+        _networkThread->setObjectName ("qtredmine network");
+        _networkThread->start ();
+        moveToThread (_networkThread);
+    }
+    else
+    {
+        if (QThread::currentThread () == _networkThread) {
+            qCritical () << "[RedmineClient][setThreadMode] Cannot leave the network thread from within";
+            return;
+        }
+
+        QThread *owner = QThread::currentThread ();
+        QMetaObject::invokeMethod (this, [this, owner]() { moveToThread (owner); }, Qt::BlockingQueuedConnection);
+        stopNetworkThread ();
+    }
+
+    // Open connections belong to the thread they were made on, so start over on the new one
+    reconnect ();
+}
+
+void
+RedmineClient::setCallbackContext (QObject* context)
+{
+    _callbackContext.store (context);
+}
+
+QString
+RedmineClient::negotiatedProtocol (const QString& host) const
+{
+    // Other threads read it directly instead of waiting for the client's thread
+    QMutexLocker locker (&_stateMutex);
+
+    return _protocols.value (host.isEmpty () ? QUrl (_url).host () : host);
+}
+
+void
+RedmineClient::recordProtocol (QNetworkReply* reply)
+{
+    QString protocol = "http/1.1";
+
+    if (reply->attribute (QNetworkRequest::Http2WasUsedAttribute).toBool ())
+        protocol = "h2";
+    else if (reply->attribute (QNetworkRequest::HttpPipeliningWasUsedAttribute).toBool ())
+        protocol = "http/1.1 pipelined";
+
+    QString host = reply->url ().host ();
+
+    if (_protocols.value (host) != protocol)
+    {
+        qDebug () << "[RedmineClient][recordProtocol]" << host << "uses" << protocol;
+        {
+            QMutexLocker locker (&_stateMutex);
+            _protocols.insert (host, protocol);
+        }
+        emit protocolNegotiated (host, protocol);
+    }
+}
+
 void
 RedmineClient::setUserAgent( const QByteArray& userAgent )
 {
     ENTER()(userAgent);
 
+    if( forwardToClientThread( [=]() { setUserAgent( userAgent ); } ) )
+        RETURN();
+
     _userAgent = userAgent;
 
     RETURN();
 }
 
-QNetworkReply*
+RequestHandle
 RedmineClient::sendRequest (const QString& resource, JsonCb callback,
                             const QNetworkAccessManager::Operation mode,
-                            const QString& queryParams, const QByteArray& postData)
+                            const QString& queryParams, const QByteArray& postData,
+                            RequestPriority priority, QSharedPointer<JsonStreamReader> reader)
+{
+    if (mode == QNetworkAccessManager::GetOperation && !callback) {
+        qCritical () << "[RedmineClient][sendRequest] No callback specified for HTTP GET mode";
+        return RequestHandle ();
+    }
+
+    RequestHandle handle (this, _nextRequestId.fetchAndAddRelaxed (1));
+    QWeakPointer<RequestHandle::State> state = handle._state;
+    QObject *receiver = callbackReceiver ();
+
+    // Callbacks of cancelled requests are dropped, even if they are already scheduled
+    auto call = [state, callback](QNetworkReply* reply, QJsonDocument* json)
+    {
+        QSharedPointer<RequestHandle::State> strong = state.toStrongRef ();
+        if (callback && !(strong && strong->cancelled))
+            callback (reply, json);
+    };
+
+    JsonCb guarded = [call, receiver](QNetworkReply* reply, QJsonDocument* json)
+    {
+        if (receiver->thread () == QThread::currentThread ()) {
+            call (reply, json);
+            return;
+        }
+
+        // The reply is deleted once all callbacks have returned, so the other thread gets a copy
+        QSharedPointer<QNetworkReply> copy (new DetachedReply (reply), &QObject::deleteLater);
+        copy->moveToThread (receiver->thread ());
+        QJsonDocument document = *json;
+
+        QMetaObject::invokeMethod (receiver, [call, copy, document]()
+        {
+            QJsonDocument json = document;
+            call (copy.data (), &json);
+        }, Qt::QueuedConnection);
+    };
+
+    return submitRequest (handle, guarded, resource, mode, queryParams, postData, priority, reader);
+}
+
+RequestHandle
+RedmineClient::decodeRequest (const QString& resource, DecodeCb decode, const QString& queryParams,
+                              RequestPriority priority)
+{
+    if (!decode) {
+        qCritical () << "[RedmineClient][decodeRequest] No decoder specified";
+        return RequestHandle ();
+    }
+
+    RequestHandle handle (this, _nextRequestId.fetchAndAddRelaxed (1));
+    QWeakPointer<RequestHandle::State> state = handle._state;
+    QObject *receiver = callbackReceiver ();
+    QThreadPool *pool = &_decoderPool;
+
+    // A response answered from disk and then revalidated is decoded twice, in that order
+    QSharedPointer<QFuture<void>> previous (new QFuture<void> ());
+
+    // Decoded on the thread pool; only the result is handed to the callback's thread
+    JsonCb guarded = [state, decode, receiver, pool, previous](QNetworkReply* reply, QJsonDocument* json)
+    {
+        QSharedPointer<RequestHandle::State> strong = state.toStrongRef ();
+        if (strong && strong->cancelled)
+            return;
+
+        // The reply is deleted once all callbacks have returned, so the decoder gets a copy
+        QSharedPointer<QNetworkReply> copy (new DetachedReply (reply), &QObject::deleteLater);
+        QJsonDocument document = *json;
+        QFuture<void> before = *previous;
+
+        *previous = QtConcurrent::run (pool, [state, decode, receiver, copy, document, before]() mutable
+        {
+            before.waitForFinished ();
+            std::function<void()> deliver = decode (copy.data (), &document);
+
+            // Cancelling while decoding still drops the result
+            QMetaObject::invokeMethod (receiver, [state, deliver]()
+            {
+                QSharedPointer<RequestHandle::State> strong = state.toStrongRef ();
+                if (deliver && !(strong && strong->cancelled))
+                    deliver ();
+            }, Qt::QueuedConnection);
+        } );
+    };
+
+    return submitRequest (handle, guarded, resource, QNetworkAccessManager::GetOperation, queryParams,
+                          QByteArray (), priority, QSharedPointer<JsonStreamReader> ());
+}
+
+QObject*
+RedmineClient::callbackReceiver () const
+{
+    // Callbacks are called on the thread of the callback context, or else on the calling thread
+    QObject *receiver = _callbackContext.load ();
+    if (!receiver)
+        receiver = threadContext ();
+
+    return receiver;
+}
+
+RequestHandle
+RedmineClient::submitRequest (const RequestHandle& handle, JsonCb guarded, const QString& resource,
+                              const QNetworkAccessManager::Operation mode, const QString& queryParams,
+                              const QByteArray& postData, RequestPriority priority,
+                              QSharedPointer<JsonStreamReader> reader)
+{
+    // Other threads do not wait for the request to be queued, so a rejection reaches the callback
+    if (forwardToClientThread ([=]()
+        {
+            if (!queueRequest (handle, guarded, resource, mode, queryParams, postData, priority, reader)) {
+                RejectedReply reply;
+                QJsonDocument json;
+                guarded (&reply, &json);
+            }
+        } ))
+        return handle;
+
+    if (!queueRequest (handle, guarded, resource, mode, queryParams, postData, priority, reader))
+        return RequestHandle ();
+
+    return handle;
+}
+
+bool
+RedmineClient::queueRequest (const RequestHandle& handle, JsonCb guarded, const QString& resource,
+                             const QNetworkAccessManager::Operation mode,
+                             const QString& queryParams, const QByteArray& postData,
+                             RequestPriority priority, QSharedPointer<JsonStreamReader> reader)
 {
     //
     // Initial checks
     //
 
     if (!_nma) {
-        qCritical () << "[RedmineClient][sendRequest] Network manager not yet initialised";
-        return nullptr;
+        qCritical () << "[RedmineClient][queueRequest] Network manager not yet initialised";
+        return false;
     }
-    if (resource.isEmpty ()) {
-        qCritical () << "[RedmineClient][sendRequest] No resource specified";
-        return nullptr;
+    if (!auth_) {
+        qCritical () << "[RedmineClient][queueRequest] No authenticator set";
+        return false;
     }
-    if (mode == QNetworkAccessManager::GetOperation && !callback) {
-        qCritical () << "[RedmineClient][sendRequest] No callback specified for HTTP GET mode";
-        return nullptr;
+    if (resource.isEmpty ()) {
+        qCritical () << "[RedmineClient][queueRequest] No resource specified";
+        return false;
     }
 
     //
@@ -219,11 +798,11 @@ RedmineClient::sendRequest (const QString& resource, JsonCb callback,
     QUrl url = _url + "/" + resource + ".json?" + queryParams;
 
     if (!url.isValid ()) {
-        qCritical () << "[RedmineClient][sendRequest] Invalid URL";
-        return nullptr;
+        qCritical () << "[RedmineClient][queueRequest] Invalid URL";
+        return false;
     }
     else
-        qDebug () << "[RedmineClient][sendRequest] Using URL:" << url;
+        qDebug () << "[RedmineClient][queueRequest] Using URL:" << url;
 
     //
     // Build the network request
@@ -236,38 +815,502 @@ RedmineClient::sendRequest (const QString& resource, JsonCb callback,
     request.setRawHeader ("Content-Length",      QByteArray::number (postData.size ()));
     auth_->addAuthentication (&request);
 
+    if (_transportMode == TransportMode::Multiplexed) {
+        request.setAttribute (QNetworkRequest::Http2AllowedAttribute, true);
+        request.setAttribute (QNetworkRequest::HttpPipeliningAllowedAttribute, true);
+    }
+
     //
-    // Perform the network action
+    // Answer from the caches or ask the server whether a previous response is still valid
     //
 
+    PendingRequest *pending = new PendingRequest ();
+    pending->callbacks.insert (handle._state->id, guarded);
+    pending->reader = reader;
+
+    // Streamed responses are only stored on disk; they are not kept decoded, so they can neither be
+    // replayed from memory nor shared with identical requests
+    bool get = mode == QNetworkAccessManager::GetOperation;
+    bool cacheable = get && !reader;
+
+    pending->persistent = get && !_diskCache.directory ().isEmpty () && _cachePolicies.contains (resource);
+    pending->revalidating = false;
+    pending->mode = mode;
+    pending->postData = postData;
+    pending->priority = priority;
+    pending->reply = nullptr;
+    pending->retries = 0;
+    pending->cancelled = false;
+
+    if (get)
+        pending->cacheKey = cacheKey (url);
+
+    if (pending->persistent)
+    {
+        ResponseCache::Entry entry;
+        if (_diskCache.lookup (pending->cacheKey, entry))
+        {
+            bool fresh = entry.storedOn.secsTo (QDateTime::currentDateTimeUtc ()) < _cachePolicies.value (resource);
+
+            // Streamed responses are answered only once, so a stale entry waits for the server
+            if (reader && fresh)
+            {
+                QByteArray body = entry.body;
+                QFutureWatcher<QJsonDocument> *watcher = new QFutureWatcher<QJsonDocument> (this);
+
+                connect (watcher, &QFutureWatcher<QJsonDocument>::finished, this, [this, watcher, url, guarded]()
+                {
+                    CachedReply *cachedReply = new CachedReply (url, this);
+                    QJsonDocument json = watcher->result ();
+                    guarded (cachedReply, &json);
+                    cachedReply->deleteLater ();
+                    watcher->deleteLater ();
+                } );
+
+                watcher->setFuture (QtConcurrent::run (&_decoderPool, [reader, body]()
+                {
+                    reader->addData (body);
+                    return reader->envelope ();
+                } ));
+
+                delete pending;
+                return true;
+            }
+
+            pending->cachedBody = entry.body;
+
+            if (!reader)
+            {
+                pending->cached = QJsonDocument::fromJson (entry.body);
+
+                // Answer from disk right away; a fresh entry needs no network at all
+                CachedReply *cachedReply = new CachedReply (url, this);
+                QJsonDocument json = pending->cached;
+                QTimer::singleShot (0, cachedReply, [cachedReply, guarded, json]() mutable
+                {
+                    guarded (cachedReply, &json);
+                    cachedReply->deleteLater ();
+                } );
+
+                if (fresh) {
+                    delete pending;
+                    return true;
+                }
+
+                // Stale: revalidate in the background
+                pending->revalidating = true;
+            }
+
+            if (!entry.etag.isEmpty ())
+                request.setRawHeader ("If-None-Match", entry.etag);
+            if (!entry.lastModified.isEmpty ())
+                request.setRawHeader ("If-Modified-Since", entry.lastModified);
+        }
+    }
+    else if (cacheable && _conditionalRequests)
+    {
+        if (const ConditionalEntry *entry = _validators.object (pending->cacheKey))
+        {
+            pending->cached = entry->json;
+
+            if (!entry->etag.isEmpty ())
+                request.setRawHeader ("If-None-Match", entry->etag);
+            if (!entry->lastModified.isEmpty ())
+                request.setRawHeader ("If-Modified-Since", entry->lastModified);
+        }
+    }
+
+    //
+    // Attach to an identical GET request that is already queued or running
+    //
+
+    PendingRequest *existing = cacheable ? _inFlightGets.value (pending->cacheKey) : nullptr;
+    if (existing)
+    {
+        qDebug () << "[RedmineClient][queueRequest] Attaching to pending request";
+        existing->callbacks.insert (handle._state->id, guarded);
+        _requestsById.insert (handle._state->id, existing);
+
+        // A queued request inherits the most urgent priority of its callers
+        if (!existing->reply && priority < existing->priority)
+        {
+            // Requests waiting for a retry are queued with their new priority once the delay is over
+            bool queued = _queues[int (existing->priority)].removeOne (existing);
+            existing->priority = priority;
+            existing->request.setPriority (networkPriority (priority));
+
+            if (queued) {
+                _queues[int (priority)].enqueue (existing);
+                dispatchRequests ();
+            }
+        }
+
+        delete pending;
+        return true;
+    }
+
+    //
+    // Queue the network action
+    //
+
+    if (mode != QNetworkAccessManager::GetOperation && mode != QNetworkAccessManager::PostOperation
+            && mode != QNetworkAccessManager::PutOperation && mode != QNetworkAccessManager::DeleteOperation)
+    {
+        qWarning () << "[RedmineClient][queueRequest] Unknown operation";
+        delete pending;
+        return false;
+    }
+
+    request.setPriority (networkPriority (priority));
+    pending->request = request;
+
+    _queues[int (priority)].enqueue (pending);
+    _requestsById.insert (handle._state->id, pending);
+
+    if (cacheable)
+        _inFlightGets.insert (pending->cacheKey, pending);
+
+    dispatchRequests ();
+
+    return true;
+}
+
+void
+RedmineClient::cancelRequest (quint64 id)
+{
+    if (forwardToClientThread ([=]() { cancelRequest (id); } ))
+        return;
+
+    PendingRequest *pending = _requestsById.take (id);
+    if (!pending)
+        return;
+
+    pending->callbacks.remove (id);
+
+    // Other callers still wait for the response
+    if (!pending->callbacks.isEmpty ())
+        return;
+
+    qDebug () << "[RedmineClient][cancelRequest] Cancelling" << pending->request.url ();
+
+    // New identical requests must not attach to the abandoned one
+    if (_inFlightGets.value (pending->cacheKey) == pending)
+        _inFlightGets.remove (pending->cacheKey);
+
+    if (pending->reply)
+        pending->reply->abort ();  // replyFinished() cleans up
+    else if (_queues[int (pending->priority)].removeOne (pending))
+        releaseRequest (pending);
+    else
+        pending->cancelled = true; // Waiting for a retry, released when the delay is over
+}
+
+void
+RedmineClient::releaseRequest (PendingRequest* pending)
+{
+    for (quint64 id : pending->callbacks.keys ())
+        _requestsById.remove (id);
+
+    if (_inFlightGets.value (pending->cacheKey) == pending)
+        _inFlightGets.remove (pending->cacheKey);
+
+    delete pending;
+}
+
+QNetworkRequest::Priority
+RedmineClient::networkPriority (RequestPriority priority)
+{
+    switch (priority)
+    {
+    case RequestPriority::Interactive:
+        return QNetworkRequest::HighPriority;
+    case RequestPriority::Prefetch:
+        return QNetworkRequest::NormalPriority;
+    default:
+        return QNetworkRequest::LowPriority;
+    }
+}
+
+void
+RedmineClient::dispatchRequests ()
+{
+    if (!_nma)
+        return;
+
+    for (int p = 0; p < REQUEST_PRIORITY_COUNT; ++p)
+    {
+        QQueue<PendingRequest*> &queue = _queues[p];
+
+        // Oldest first; requests to a host without free slots keep their place in the queue
+        for (int i = 0; i < queue.size (); )
+        {
+            PendingRequest *pending = queue.at (i);
+            QString host = pending->request.url ().host ();
+
+            // A multiplexed connection carries many more requests than there are HTTP/1.1 connections
+            int slots = _transportMode == TransportMode::Multiplexed && _protocols.value (host) == "h2"
+                    ? MAX_HTTP2_STREAMS : _maxRequestsPerHost;
+
+            // One slot per host is kept free for interactive requests
+            int limit = p == int (RequestPriority::Interactive) ? slots : qMax (1, slots - 1);
+
+            if (_runningPerHost.value (host) >= limit) {
+                ++i;
+                continue;
+            }
+
+            queue.removeAt (i);
+            startRequest (pending);
+        }
+    }
+}
+
+void
+RedmineClient::startRequest (PendingRequest *pending)
+{
     QNetworkReply *reply {nullptr};
 
-    switch (mode)
+    switch (pending->mode)
     {
     case QNetworkAccessManager::GetOperation:
-        reply = _nma->get (request);
+        reply = _nma->get (pending->request);
         break;
 
     case QNetworkAccessManager::PostOperation:
-        reply = _nma->post (request, postData);
+        reply = _nma->post (pending->request, pending->postData);
         break;
 
     case QNetworkAccessManager::PutOperation:
-        reply = _nma->put (request, postData);
+        reply = _nma->put (pending->request, pending->postData);
         break;
 
     case QNetworkAccessManager::DeleteOperation:
-        reply = _nma->deleteResource (request);
+        reply = _nma->deleteResource (pending->request);
+        break;
+
+    default:
+        break;
+    }
+
+    pending->reply = reply;
+
+    // Decode streamed responses on the thread pool while they are downloading
+    if (reply && pending->reader)
+    {
+        QSharedPointer<JsonStreamReader> reader = pending->reader;
+        connect (reply, &QNetworkReply::readyRead, this, [this, reply, pending, reader]()
+        {
+            QByteArray data = reply->readAll ();
+            if (pending->persistent)
+                pending->received += data;
+            queueDecoding (pending, [reader, data]() { reader->addData (data); } );
+        } );
+    }
+    callbacks_[reply] = pending;
+    ++_runningPerHost[pending->request.url ().host ()];
+
+    // Abort requests that stall; the deadline restarts whenever data arrives
+    if (reply && _requestTimeout > 0)
+    {
+        QTimer *deadline = new QTimer (reply);
+        deadline->setSingleShot (true);
+
+        connect (deadline, &QTimer::timeout, reply, [reply]()
+        {
+            qDebug () << "[RedmineClient][startRequest] Request timed out:" << reply->url ();
+            reply->setProperty (TIMED_OUT_PROPERTY, true);
+            reply->abort ();
+        } );
+        connect (reply, &QNetworkReply::downloadProgress, deadline, [deadline]() { deadline->start (); } );
+        connect (reply, &QNetworkReply::uploadProgress, deadline, [deadline]() { deadline->start (); } );
+
+        deadline->start (_requestTimeout);
+    }
+}
+
+/**
+ * @brief Get the delay requested by a \c Retry-After header
+ *
+ * @param reply Network reply
+ *
+ * @return Delay in milliseconds, or -1 if the header is missing or invalid
+ */
+static qint64
+retryAfter (const QNetworkReply* reply)
+{
+    QByteArray value = reply->rawHeader ("Retry-After").trimmed ();
+    if (value.isEmpty ())
+        return -1;
+
+    bool ok;
+    qint64 seconds = value.toLongLong (&ok);
+    if (ok)
+        return qMax (Q_INT64_C (0), seconds) * 1000;
+
+    // HTTP-date, e.g. "Wed, 21 Oct 2015 07:28:00 GMT"
+    QDateTime date = QLocale::c ().toDateTime (QString::fromLatin1 (value), "ddd, dd MMM yyyy HH:mm:ss 'GMT'");
+    if (!date.isValid ())
+        return -1;
+
+    date.setTimeSpec (Qt::UTC);
+    return qMax (Q_INT64_C (0), QDateTime::currentDateTimeUtc ().msecsTo (date));
+}
+
+bool
+RedmineClient::retryRequest (QNetworkReply* reply)
+{
+    PendingRequest *pending = callbacks_.value (reply);
+    int status = reply->attribute (QNetworkRequest::HttpStatusCodeAttribute).toInt ();
+
+    bool transient = false;
+
+    switch (reply->error ())
+    {
+    case QNetworkReply::NoError:
+        break;
+
+    case QNetworkReply::OperationCanceledError:
+        transient = isTimedOut (reply);
+        break;
+
+    case QNetworkReply::ConnectionRefusedError:
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::ProxyTimeoutError:
+    case QNetworkReply::UnknownNetworkError:
+        transient = true;
         break;
+
     default:
-        qWarning () << "[RedmineClient][sendRequest] Unknown operation";
-        return nullptr;
+        transient = status == 408 || status == 429 || status == 502 || status == 503 || status == 504;
+        break;
+    }
+
+    if (!transient)
+    {
+        // Successful requests refill the retry budget
+        if (reply->error () == QNetworkReply::NoError && pending->retries == 0)
+            _retryTokens = qMin (10.0, _retryTokens + 0.1);
+
+        return false;
+    }
+
+    bool idempotent = pending->mode == QNetworkAccessManager::GetOperation
+            || pending->mode == QNetworkAccessManager::PutOperation;
+
+    if (!idempotent || pending->retries >= _maxRetries || _retryTokens < 1.0)
+        return false;
+
+    // Exponential backoff with jitter, so that clients do not retry in lockstep
+    qint64 backoff = qMin (qint64 (_retryMaxDelay), qint64 (_retryBaseDelay) << pending->retries);
+    qint64 delay = backoff / 2 + QRandomGenerator::global ()->bounded (int (backoff / 2) + 1);
+
+    qint64 requested = retryAfter (reply);
+    if (requested > MAX_RETRY_AFTER)
+        return false;
+    delay = qMax (delay, requested);
+
+    qDebug () << "[RedmineClient][retryRequest] Retrying" << reply->url () << "in" << delay << "ms";
+
+    _retryTokens -= 1.0;
+    ++pending->retries;
+
+    if (pending->reader) {
+        QSharedPointer<JsonStreamReader> reader = pending->reader;
+        queueDecoding (pending, [reader]() { reader->restart (); } );
+        pending->received.clear ();
+    }
+
+    callbacks_.remove (reply);
+    --_runningPerHost[pending->request.url ().host ()];
+    pending->reply = nullptr;
+
+    QTimer::singleShot (int (delay), this, [this, pending]()
+    {
+        if (pending->cancelled) {
+            releaseRequest (pending);
+            return;
+        }
+
+        _queues[int (pending->priority)].enqueue (pending);
+        dispatchRequests ();
+    } );
+
+    return true;
+}
+
+bool
+RedmineClient::refetchUncached (QNetworkReply* reply)
+{
+    PendingRequest *pending = callbacks_.value (reply);
+    int status = reply->attribute (QNetworkRequest::HttpStatusCodeAttribute).toInt ();
+
+    // Requests without validators cannot loop here, the server has nothing to compare against
+    bool conditional = pending->request.hasRawHeader ("If-None-Match")
+            || pending->request.hasRawHeader ("If-Modified-Since");
+
+    // Streamed responses replay the stored body instead of a decoded document
+    bool replayable = pending->reader ? !pending->cachedBody.isEmpty () : !pending->cached.isNull ();
+
+    if (status != 304 || replayable || !conditional)
+        return false;
+
+    qDebug () << "[RedmineClient][refetchUncached] Nothing to replay for" << reply->url () << ", requesting it again";
+
+    _validators.remove (pending->cacheKey);
+
+    // A null value removes the header
+    pending->request.setRawHeader ("If-None-Match", QByteArray ());
+    pending->request.setRawHeader ("If-Modified-Since", QByteArray ());
+
+    callbacks_.remove (reply);
+    --_runningPerHost[pending->request.url ().host ()];
+    pending->reply = nullptr;
+
+    _queues[int (pending->priority)].enqueue (pending);
+
+    return true;
+}
+
+bool
+RedmineClient::forwardToClientThread (const std::function<void()>& call) const
+{
+    if (QThread::currentThread () == thread ())
+        return false;
+
+    QMetaObject::invokeMethod (const_cast<RedmineClient*> (this), call, Qt::QueuedConnection);
+    return true;
+}
+
+void
+RedmineClient::stopNetworkThread ()
+{
+    _networkThread->quit ();
+
+    // A client deleted by its own event loop cannot wait for it
+    if (QThread::currentThread () == _networkThread)
+        connect (_networkThread, &QThread::finished, _networkThread, &QObject::deleteLater);
+    else {
+        _networkThread->wait ();
+        delete _networkThread;
     }
 
-    if (reply && callback)
-        callbacks_[reply] = callback;
+    _networkThread = nullptr;
+}
 
-    return reply;
+void
+RedmineClient::queueDecoding (PendingRequest* pending, std::function<void()> step)
+{
+    QFuture<void> previous = pending->decoding;
+
+    pending->decoding = QtConcurrent::run (&_decoderPool, [previous, step]() mutable
+    {
+        // Waiting for a step that has not started yet runs it on this thread instead
+        previous.waitForFinished ();
+        step ();
+    } );
 }
 
 void
@@ -275,19 +1318,126 @@ RedmineClient::replyFinished( QNetworkReply* reply )
 {
     ENTER()(reply);
 
-    // Search for callback function
-    if( reply && callbacks_.contains(reply) )
-    {
-        QByteArray data_raw = reply->readAll();
-        QJsonDocument data_json = QJsonDocument::fromJson( data_raw );
-
-        JsonCb callback = callbacks_[reply];
-        callback( reply, &data_json );
+    if( reply && reply->error() == QNetworkReply::NoError )
+        recordProtocol( reply );
 
-        callbacks_.remove( reply );
+    // Search for callback function, unless the request is sent again
+    if( reply && callbacks_.contains(reply) && !retryRequest( reply ) && !refetchUncached( reply ) )
+    {
+        PendingRequest *pending = callbacks_.take (reply);
+        --_runningPerHost[pending->request.url ().host ()];
+
+        if (_inFlightGets.value (pending->cacheKey) == pending)
+            _inFlightGets.remove (pending->cacheKey);
+
+        // Callbacks may cancel or send requests, so work on a copy that is no longer cancellable
+        const QMap<quint64, JsonCb> waiting = pending->callbacks;
+        for (quint64 id : waiting.keys ())
+            _requestsById.remove (id);
+
+        int status = reply->attribute (QNetworkRequest::HttpStatusCodeAttribute).toInt ();
+
+        // The body is decoded on the thread pool; the callbacks are called here once it is done
+        QSharedPointer<QJsonDocument> data_json (new QJsonDocument ());
+        bool notify = true;
+        bool remember = false;
+        int cost = 1;
+        QByteArray etag = reply->rawHeader ("ETag");
+        QByteArray lastModified = reply->rawHeader ("Last-Modified");
+
+        if (pending->reader)
+        {
+            QSharedPointer<JsonStreamReader> reader = pending->reader;
+            QByteArray data_raw = reply->readAll ();
+
+            if (status == 304 && !pending->cachedBody.isEmpty ())
+            {
+                // Not modified: hand out the elements of the stored page
+                _diskCache.touch (pending->cacheKey);
+                data_raw = pending->cachedBody;
+            }
+            else if (pending->persistent && reply->error () == QNetworkReply::NoError && status == 200)
+                _diskCache.store (pending->cacheKey, ResponseCache::Entry {pending->received + data_raw, etag,
+                                                                           lastModified, QDateTime ()});
+
+            // The elements have been handed out while downloading, only the envelope is left
+            queueDecoding (pending, [data_json, reader, data_raw]()
+            {
+                reader->addData (data_raw);
+                *data_json = reader->envelope ();
+            } );
+        }
+        else if (status == 304 && !pending->cached.isNull ())
+        {
+            if (pending->persistent)
+                _diskCache.touch (pending->cacheKey);
+
+            // Not modified: replay the previously decoded document, unless already answered from disk
+            *data_json = pending->cached;
+            notify = !pending->revalidating;
+        }
+        else if (pending->persistent)
+        {
+            QByteArray data_raw = reply->readAll();
+            bool ok = reply->error () == QNetworkReply::NoError && status == 200;
+            bool changed = !pending->revalidating || data_raw != pending->cachedBody;
+
+            if (ok && changed)
+                _diskCache.store (pending->cacheKey, ResponseCache::Entry {data_raw, etag, lastModified,
+                                                                           QDateTime ()});
+            else if (ok)
+                _diskCache.touch (pending->cacheKey);
+
+            // After answering from disk, only report changed data
+            notify = !pending->revalidating || (ok && changed);
+
+            if (notify)
+                queueDecoding (pending, [data_json, data_raw]() { *data_json = QJsonDocument::fromJson (data_raw); } );
+            else if (!ok)
+                qDebug () << "[RedmineClient][replyFinished] Revalidation failed:" << reply->errorString ();
+        }
+        else
+        {
+            QByteArray data_raw = reply->readAll();
+            queueDecoding (pending, [data_json, data_raw]() { *data_json = QJsonDocument::fromJson (data_raw); } );
+
+            // Remember the validators for the next request of this URL
+            if (!pending->cacheKey.isEmpty () && _conditionalRequests
+                    && reply->error () == QNetworkReply::NoError && status == 200)
+            {
+                remember = !etag.isEmpty () || !lastModified.isEmpty ();
+                cost = 1 + data_raw.size () / 1024;
+
+                if (!remember)
+                    _validators.remove (pending->cacheKey);
+            }
+        }
+
+        // The reply is handed to the callbacks later, so keep it even if the network access manager
+        // is replaced in the meantime
+        QFutureWatcher<void> *watcher = new QFutureWatcher<void> (this);
+        reply->setParent (watcher);
+
+        connect (watcher, &QFutureWatcher<void>::finished, this, [=]()
+        {
+            if (remember)
+                _validators.insert (pending->cacheKey, new ConditionalEntry {etag, lastModified, *data_json}, cost);
+
+            if (notify)
+                for (const JsonCb &callback : waiting)
+                    callback( reply, data_json.data () );
+
+            releaseRequest (pending);
+            watcher->deleteLater ();
+        } );
+
+        watcher->setFuture (pending->decoding);
     }
+    else if (reply)
+        reply->deleteLater();
 
-    reply->deleteLater();
+    // A slot has become free
+    dispatchRequests ();
 
     RETURN();
 }
@@ -308,9 +1458,19 @@ getResMode( const int id, QString& resource, QNetworkAccessManager::Operation& m
     RETURN();
 }
 
-void
+RequestHandle
+RedmineClient::streamRequest (const QString& resource, const QByteArray& arrayKey,
+                              JsonStreamReader::ElementCb element, JsonCb callback,
+                              const QString& queryParams, RequestPriority priority)
+{
+    QSharedPointer<JsonStreamReader> reader (new JsonStreamReader (arrayKey, element));
+    return sendRequest (resource, callback, QNetworkAccessManager::GetOperation, queryParams, "", priority,
+                        reader);
+}
+
+RequestHandle
 RedmineClient::sendCustomField(const QJsonDocument& data, JsonCb callback, int id,
-                                const QString& parameters )
+                                const QString& parameters, RequestPriority priority )
 {
     ENTER()(parameters);
 
@@ -319,14 +1479,14 @@ RedmineClient::sendCustomField(const QJsonDocument& data, JsonCb callback, int i
 
     getResMode( id, resource, mode );
 
-    sendRequest( resource, callback, mode, parameters, data.toJson() );
+    RequestHandle handle = sendRequest( resource, callback, mode, parameters, data.toJson(), priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
+RequestHandle
 RedmineClient::sendEnumeration( const QString& enumeration, const QJsonDocument& data, JsonCb callback,
-                                const int id, const QString& parameters )
+                                const int id, const QString& parameters, RequestPriority priority )
 {
     ENTER()(enumeration)(parameters);
 
@@ -335,14 +1495,14 @@ RedmineClient::sendEnumeration( const QString& enumeration, const QJsonDocument&
 
     getResMode( id, resource, mode );
 
-    sendRequest( resource, callback, mode, parameters, data.toJson() );
+    RequestHandle handle = sendRequest( resource, callback, mode, parameters, data.toJson(), priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
+RequestHandle
 RedmineClient::sendIssue(const QJsonDocument& data, JsonCb callback, int id,
-                          const QString& parameters )
+                          const QString& parameters, RequestPriority priority )
 {
     ENTER()(id)(parameters);
 
@@ -351,14 +1511,14 @@ RedmineClient::sendIssue(const QJsonDocument& data, JsonCb callback, int id,
 
     getResMode( id, resource, mode );
 
-    sendRequest( resource, callback, mode, parameters, data.toJson() );
+    RequestHandle handle = sendRequest( resource, callback, mode, parameters, data.toJson(), priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
+RequestHandle
 RedmineClient::sendIssueCategory( const QJsonDocument& data, JsonCb callback, const int id,
-                                  const QString& parameters )
+                                  const QString& parameters, RequestPriority priority )
 {
     ENTER()(parameters);
 
@@ -367,14 +1527,14 @@ RedmineClient::sendIssueCategory( const QJsonDocument& data, JsonCb callback, co
 
     getResMode( id, resource, mode );
 
-    sendRequest( resource, callback, mode, parameters, data.toJson() );
+    RequestHandle handle = sendRequest( resource, callback, mode, parameters, data.toJson(), priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
+RequestHandle
 RedmineClient::sendIssuePriority( const QJsonDocument& data, JsonCb callback, const int id,
-                                  const QString& parameters )
+                                  const QString& parameters, RequestPriority priority )
 {
     ENTER()(parameters);
 
@@ -383,14 +1543,14 @@ RedmineClient::sendIssuePriority( const QJsonDocument& data, JsonCb callback, co
 
     getResMode( id, resource, mode );
 
-    sendEnumeration( resource, data, callback, id, parameters );
+    RequestHandle handle = sendEnumeration( resource, data, callback, id, parameters, priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
+RequestHandle
 RedmineClient::sendIssueStatus( const QJsonDocument& data, JsonCb callback, const int id,
-                                const QString& parameters )
+                                const QString& parameters, RequestPriority priority )
 {
     ENTER()(parameters);
 
@@ -399,14 +1559,14 @@ RedmineClient::sendIssueStatus( const QJsonDocument& data, JsonCb callback, cons
 
     getResMode( id, resource, mode );
 
-    sendRequest( resource, callback, mode, parameters, data.toJson() );
+    RequestHandle handle = sendRequest( resource, callback, mode, parameters, data.toJson(), priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
+RequestHandle
 RedmineClient::sendProject( const QJsonDocument& data, JsonCb callback, const int id,
-                            const QString& parameters )
+                            const QString& parameters, RequestPriority priority )
 {
     ENTER()(parameters);
 
@@ -415,14 +1575,14 @@ RedmineClient::sendProject( const QJsonDocument& data, JsonCb callback, const in
 
     getResMode( id, resource, mode );
 
-    sendRequest( resource, callback, mode, parameters, data.toJson() );
+    RequestHandle handle = sendRequest( resource, callback, mode, parameters, data.toJson(), priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
+RequestHandle
 RedmineClient::sendTimeEntry( const QJsonDocument& data, JsonCb callback, const int id,
-                              const QString& parameters )
+                              const QString& parameters, RequestPriority priority )
 {
     ENTER()(parameters);
 
@@ -431,14 +1591,14 @@ RedmineClient::sendTimeEntry( const QJsonDocument& data, JsonCb callback, const
 
     getResMode( id, resource, mode );
 
-    sendRequest( resource, callback, mode, parameters, data.toJson() );
+    RequestHandle handle = sendRequest( resource, callback, mode, parameters, data.toJson(), priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
+RequestHandle
 RedmineClient::sendTimeEntryActivity( const QJsonDocument& data, JsonCb callback, const int id,
-                                      const QString& parameters )
+                                      const QString& parameters, RequestPriority priority )
 {
     ENTER()(parameters);
 
@@ -447,14 +1607,14 @@ RedmineClient::sendTimeEntryActivity( const QJsonDocument& data, JsonCb callback
 
     getResMode( id, resource, mode );
 
-    sendEnumeration( resource, data, callback, id, parameters );
+    RequestHandle handle = sendEnumeration( resource, data, callback, id, parameters, priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
+RequestHandle
 RedmineClient::sendTracker( const QJsonDocument& data, JsonCb callback, const int id,
-                            const QString& parameters )
+                            const QString& parameters, RequestPriority priority )
 {
     ENTER()(parameters);
 
@@ -463,13 +1623,14 @@ RedmineClient::sendTracker( const QJsonDocument& data, JsonCb callback, const in
 
     getResMode( id, resource, mode );
 
-    sendRequest( resource, callback, mode, parameters, data.toJson() );
+    RequestHandle handle = sendRequest( resource, callback, mode, parameters, data.toJson(), priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-RedmineClient::sendUser( const QJsonDocument& data, JsonCb callback, const int id, const QString& parameters )
+RequestHandle
+RedmineClient::sendUser( const QJsonDocument& data, JsonCb callback, const int id, const QString& parameters,
+                         RequestPriority priority )
 {
     ENTER()(parameters);
 
@@ -478,165 +1639,181 @@ RedmineClient::sendUser( const QJsonDocument& data, JsonCb callback, const int i
 
     getResMode( id, resource, mode );
 
-    sendRequest( resource, callback, mode, parameters, data.toJson() );
+    RequestHandle handle = sendRequest( resource, callback, mode, parameters, data.toJson(), priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-RedmineClient::retrieveCustomFields( JsonCb callback, const QString& parameters )
+RequestHandle
+RedmineClient::retrieveCustomFields( JsonCb callback, const QString& parameters, RequestPriority priority )
 {
     ENTER()(parameters);
 
-    sendRequest( "shared/custom_fields", callback, QNetworkAccessManager::GetOperation, parameters );
+    RequestHandle handle = sendRequest( "shared/custom_fields", callback,
+                                        QNetworkAccessManager::GetOperation, parameters, "",
+                                        priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-RedmineClient::retrieveEnumerations( const QString& enumeration, JsonCb callback, const QString& parameters )
+RequestHandle
+RedmineClient::retrieveEnumerations( const QString& enumeration, JsonCb callback, const QString& parameters,
+                                     RequestPriority priority )
 {
     ENTER()(enumeration)(parameters);
 
-    sendRequest( "enumerations/"+enumeration, callback, QNetworkAccessManager::GetOperation, parameters );
+    RequestHandle handle = sendRequest( "enumerations/"+enumeration, callback,
+                                        QNetworkAccessManager::GetOperation, parameters, "",
+                                        priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-RedmineClient::retrieveIssues (JsonCb callback, const QString& parameters)
+RequestHandle
+RedmineClient::retrieveIssues (JsonCb callback, const QString& parameters, RequestPriority priority)
 {
-    sendRequest ("issues", callback, QNetworkAccessManager::GetOperation, parameters);
+    return sendRequest ("issues", callback, QNetworkAccessManager::GetOperation, parameters, "", priority);
 }
 
-void
-RedmineClient::retrieveIssueCategories( JsonCb callback, const int projectId, const QString& parameters )
+RequestHandle
+RedmineClient::retrieveIssueCategories( JsonCb callback, const int projectId, const QString& parameters,
+                                        RequestPriority priority )
 {
     ENTER()(projectId)(parameters);
 
-    sendRequest( QString("projects/%1/issue_categories").arg(projectId), callback,
-                 QNetworkAccessManager::GetOperation, parameters );
+    RequestHandle handle = sendRequest( QString("projects/%1/issue_categories").arg(projectId), callback,
+                                        QNetworkAccessManager::GetOperation, parameters, "", priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-RedmineClient::retrieveIssuePriorities( JsonCb callback, const QString& parameters )
+RequestHandle
+RedmineClient::retrieveIssuePriorities( JsonCb callback, const QString& parameters, RequestPriority priority )
 {
     ENTER()(parameters);
 
-    retrieveEnumerations( "issue_priorities", callback, parameters );
+    RequestHandle handle = retrieveEnumerations( "issue_priorities", callback, parameters, priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-RedmineClient::retrieveIssue( JsonCb callback, const int issueId, const QString& parameters )
+RequestHandle
+RedmineClient::retrieveIssue( JsonCb callback, const int issueId, const QString& parameters,
+                              RequestPriority priority )
 {
     ENTER()(issueId)(parameters);
 
-    sendRequest( QString("issues/%1").arg(issueId), callback, QNetworkAccessManager::GetOperation,
-                 parameters );
+    RequestHandle handle = sendRequest( QString("issues/%1").arg(issueId), callback,
+                                        QNetworkAccessManager::GetOperation,
+                                        parameters, "", priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-RedmineClient::retrieveIssueStatuses( JsonCb callback, const QString& parameters )
+RequestHandle
+RedmineClient::retrieveIssueStatuses( JsonCb callback, const QString& parameters, RequestPriority priority )
 {
     ENTER()(parameters);
 
-    sendRequest( "issue_statuses", callback, QNetworkAccessManager::GetOperation, parameters );
+    RequestHandle handle = sendRequest( "issue_statuses", callback, QNetworkAccessManager::GetOperation,
+                                        parameters, "", priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-RedmineClient::retrieveMemberships( JsonCb callback, const int projectId, const QString& parameters )
+RequestHandle
+RedmineClient::retrieveMemberships( JsonCb callback, const int projectId, const QString& parameters,
+                                    RequestPriority priority )
 {
     ENTER()(projectId)(parameters);
 
-    sendRequest( QString("projects/%1/memberships").arg(projectId), callback,
-                 QNetworkAccessManager::GetOperation, parameters );
+    RequestHandle handle = sendRequest( QString("projects/%1/memberships").arg(projectId), callback,
+                                        QNetworkAccessManager::GetOperation, parameters, "", priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-RedmineClient::retrieveProject( JsonCb callback, const int projectId, const QString& parameters )
+RequestHandle
+RedmineClient::retrieveProject( JsonCb callback, const int projectId, const QString& parameters,
+                                RequestPriority priority )
 {
     ENTER()(projectId)(parameters);
 
-    sendRequest( QString("projects/%1").arg(projectId), callback, QNetworkAccessManager::GetOperation,
-                 QString("%1&include=%2").arg(parameters).arg("enabled_modules,issue_categories,trackers") );
+    RequestHandle handle = sendRequest( QString("projects/%1").arg(projectId), callback,
+                                        QNetworkAccessManager::GetOperation, parameters, "", priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-RedmineClient::retrieveProjects (JsonCb callback, const QString& parameters)
+RequestHandle
+RedmineClient::retrieveProjects (JsonCb callback, const QString& parameters, RequestPriority priority)
 {
-    sendRequest ("projects", callback, QNetworkAccessManager::GetOperation,
-                 QString ("%1&include=%2").arg (parameters).arg ("enabled_modules,issue_categories,trackers"));
+    return sendRequest ("projects", callback, QNetworkAccessManager::GetOperation, parameters, "", priority);
 }
 
-void
-RedmineClient::retrieveTimeEntries( JsonCb callback, const QString& parameters )
+RequestHandle
+RedmineClient::retrieveTimeEntries( JsonCb callback, const QString& parameters, RequestPriority priority )
 {
     ENTER()(parameters);
 
-    sendRequest( "time_entries", callback, QNetworkAccessManager::GetOperation, parameters );
+    RequestHandle handle = sendRequest( "time_entries", callback, QNetworkAccessManager::GetOperation,
+                                        parameters, "", priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-RedmineClient::retrieveTimeEntryActivities( JsonCb callback, const QString& parameters )
+RequestHandle
+RedmineClient::retrieveTimeEntryActivities( JsonCb callback, const QString& parameters,
+                                            RequestPriority priority )
 {
     ENTER()(parameters);
 
-    retrieveEnumerations( "time_entry_activities", callback, parameters );
+    RequestHandle handle = retrieveEnumerations( "time_entry_activities", callback, parameters, priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-RedmineClient::retrieveTrackers( JsonCb callback, const QString& parameters )
+RequestHandle
+RedmineClient::retrieveTrackers( JsonCb callback, const QString& parameters, RequestPriority priority )
 {
     ENTER()(parameters);
 
-    sendRequest( "trackers", callback, QNetworkAccessManager::GetOperation, parameters );
+    RequestHandle handle = sendRequest( "trackers", callback, QNetworkAccessManager::GetOperation,
+                                        parameters, "", priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-RedmineClient::retrieveCurrentUser( JsonCb callback, const QString& parameters )
+RequestHandle
+RedmineClient::retrieveCurrentUser( JsonCb callback, const QString& parameters, RequestPriority priority )
 {
     ENTER()(parameters);
 
-    sendRequest( "users/current", callback, QNetworkAccessManager::GetOperation, parameters );
+    RequestHandle handle = sendRequest( "users/current", callback, QNetworkAccessManager::GetOperation,
+                                        parameters, "", priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-RedmineClient::retrieveUsers( JsonCb callback, const QString& parameters )
+RequestHandle
+RedmineClient::retrieveUsers( JsonCb callback, const QString& parameters, RequestPriority priority )
 {
     ENTER()(parameters);
 
-    sendRequest( "users", callback, QNetworkAccessManager::GetOperation, parameters );
+    RequestHandle handle = sendRequest( "users", callback, QNetworkAccessManager::GetOperation, parameters,
+                                        "", priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-RedmineClient::retrieveVersions( JsonCb callback, const int projectId, const QString& parameters )
+RequestHandle
+RedmineClient::retrieveVersions( JsonCb callback, const int projectId, const QString& parameters,
+                                 RequestPriority priority )
 {
     ENTER()(projectId)(parameters);
 
-    sendRequest( QString("projects/%1/versions").arg(projectId), callback,
-                 QNetworkAccessManager::GetOperation, parameters );
+    RequestHandle handle = sendRequest( QString("projects/%1/versions").arg(projectId), callback,
+                                        QNetworkAccessManager::GetOperation, parameters, "", priority );
 
-    RETURN();
+    RETURN( handle );
 }
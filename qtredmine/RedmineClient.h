@@ -2,14 +2,29 @@
 #define REDMINECLIENT_H
 
 #include "Authenticator.h"
+#include "JsonStreamReader.h"
+#include "RequestHandle.h"
+#include "ResponseCache.h"
 
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QAtomicPointer>
 #include <QtCore/QByteArray>
+#include <QtCore/QCache>
 #include <QtCore/QDebug>
+#include <QtCore/QFuture>
+#include <QtCore/QHash>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QMap>
+#include <QtCore/QMutex>
 #include <QtNetwork/QNetworkAccessManager>
 #include <QtNetwork/QNetworkReply>
 #include <QtCore/QObject>
+#include <QtCore/QQueue>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+#include <QtNetwork/QNetworkRequest>
 
 #include <functional>
 
@@ -18,6 +33,28 @@
 /// QtRedmine namespace
 namespace qtredmine {
 
+/// Scheduling priority of a request; requests of a more urgent class are always started first
+enum class RequestPriority {
+    Interactive, ///< The user is waiting for the result
+    Prefetch,    ///< The result will probably be needed soon
+    Background,  ///< Bulk transfers and housekeeping
+};
+
+/// Number of request priority classes
+const int REQUEST_PRIORITY_COUNT = 3;
+
+/// HTTP transport used for requests
+enum class TransportMode {
+    Standard,    ///< Plain HTTP/1.1 with up to six parallel connections per host
+    Multiplexed, ///< HTTP/2 negotiated via ALPN, falling back to pipelined HTTP/1.1
+};
+
+/// Thread the client does its networking on
+enum class ThreadMode {
+    OwnerThread,   ///< The thread that created the client
+    NetworkThread, ///< An internal thread owned by the client
+};
+
 /**
  * @example Example.h
  * @example Example.cpp
@@ -35,10 +72,15 @@ class RedmineClient : public QObject
 {
     Q_OBJECT
 
+    friend class RequestHandle;
+
 public:
     /// Typedef for a JSON callback function
     using JsonCb = std::function<void(QNetworkReply*, QJsonDocument*)>;
 
+    /// Typedef for a decoder run on the thread pool, returning the call to make with its result
+    using DecodeCb = std::function<std::function<void()>(QNetworkReply*, QJsonDocument*)>;
+
 public:
     //! @brief Constructor for an unconfigured Redmine connection
     //! @param parent Parent QObject (default: nullptr)
@@ -67,13 +109,29 @@ public:
     RedmineClient (const QString& url, const QString& login, const QString& password,
                    const bool checkSsl = true, QObject* parent = nullptr );
 
+    //! @brief Destructor; stops the network thread
+    virtual ~RedmineClient ();
+
     //! @brief (Re-)Connect to Redmine
     void reconnect ();
 
+    //! @brief Establish the connection to the Redmine host ahead of the first request
+    //!
+    //! Resolves the host and performs the TCP and TLS handshakes in the background, so that the
+    //! first request can use an open connection. Called by setUrl(); repeated calls for the same
+    //! host within 30 seconds have no effect.
+    //!
+    //! @param target URL to connect to without setting it, e.g. while it is being entered; the
+    //!               Redmine URL if empty
+    void preconnect (const QString& target = QString ());
+
     /// @name Getters
     /// @{
 
     //! @brief Get the Redmine base URL
+    //!
+    //! From another thread, a URL set there only shows once the client's thread has applied it.
+    //!
     //! @return Redmine base URL
     QString getUrl () const;
 
@@ -83,6 +141,9 @@ public:
     /// @{
 
     //! @brief Set the Redmine base URL
+    //!
+    //! Starts connecting to the host right away, see preconnect().
+    //!
     //! @param url Redmine base URL
     void setUrl (const QString& url);
 
@@ -106,6 +167,112 @@ public:
     //! @param checkSsl Check SSL data
     void setCheckSsl (bool checkSsl);
 
+    //! @brief Enable or disable conditional GET requests (default: enabled)
+    //!
+    //! When enabled, the \c ETag and \c Last-Modified validators of GET responses are remembered
+    //! per canonical URL and sent back as \c If-None-Match and \c If-Modified-Since. On
+    //! <tt>304 Not Modified</tt> the previously decoded document is passed to the callback.
+    //!
+    //! @param enabled Use conditional requests
+    void setConditionalRequests (bool enabled);
+
+    //! @brief Enable or disable the persistent response cache (default: enabled)
+    //!
+    //! GET requests of resources with a cache policy are answered from disk right away. Responses
+    //! older than the policy's time to live are revalidated in the background, and the callback is
+    //! called a second time if the data has changed.
+    //!
+    //! Streamed requests, which the paginated retrievers of SimpleRedmineClient use, are cached per
+    //! page. They are answered only once: from disk while the response is fresh, and otherwise by a
+    //! conditional request whose <tt>304 Not Modified</tt> replays the stored page.
+    //!
+    //! @param enabled Use the persistent response cache
+    void setDiskCacheEnabled (bool enabled);
+
+    //! @brief Set the cache policy for a resource
+    //!
+    //! @param resource   Resource as passed to sendRequest(), e.g. \c trackers
+    //! @param ttlSeconds Time in seconds after which a cached response is revalidated;
+    //!                   0 removes the resource from the persistent cache
+    void setCachePolicy (const QString& resource, int ttlSeconds);
+
+    //! @brief Set the maximum number of requests running at once per host (default: 6)
+    //!
+    //! Further requests are queued by priority and started first in, first out within a
+    //! priority class. One slot is reserved for interactive requests.
+    //!
+    //! @param maxRequests Maximum number of running requests
+    void setMaxRequestsPerHost (int maxRequests);
+
+    //! @brief Set the HTTP transport (default: TransportMode::Standard)
+    //!
+    //! In multiplexed mode, HTTP/2 is offered during the TLS handshake. If the server accepts, all
+    //! requests to the host share a single connection and up to 32 of them run at once, regardless
+    //! of setMaxRequestsPerHost(). Otherwise GET requests are pipelined over HTTP/1.1 connections.
+    //! The protocol in use is reported by protocolNegotiated().
+    //!
+    //! @param mode Transport mode
+    void setTransportMode (TransportMode mode);
+
+    //! @brief Set the thread the client does its networking on (default: ThreadMode::OwnerThread)
+    //!
+    //! In ThreadMode::NetworkThread the client moves to an internal thread, so that socket reads, TLS
+    //! and response handling do not compete with the thread that created it. Only a client without
+    //! parent can move; the mode has to be set from the thread that created the client, which also
+    //! has to delete it. Open connections are dropped, running GET requests are sent again.
+    //!
+    //! In either mode all public methods may be called from any thread. Callbacks are called on the
+    //! thread that sent the request, unless a callback context is set; that thread needs a running
+    //! event loop.
+    //!
+    //! @param mode Thread mode
+    void setThreadMode (ThreadMode mode);
+
+    //! @brief Set the object on whose thread callbacks are called
+    //!
+    //! @param context Object that outlives the client's requests; nullptr to call callbacks on the
+    //!                thread that sent the request (default)
+    void setCallbackContext (QObject* context);
+
+    //! @brief Get the protocol used for the last successful request to a host
+    //!
+    //! @param host Host name; the host of the Redmine URL if empty
+    //!
+    //! @return \c h2, \c http/1.1 or <tt>http/1.1 pipelined</tt>, empty if no request has finished
+    QString negotiatedProtocol (const QString& host = QString ()) const;
+
+    //! @brief Set the time after which a request without progress is aborted (default: 30 s)
+    //!
+    //! The deadline restarts whenever data arrives. A request that runs out of time fails with
+    //! QNetworkReply::OperationCanceledError, and isTimedOut() returns true for its reply.
+    //!
+    //! @param msecs Timeout in milliseconds; 0 disables the timeout
+    void setRequestTimeout (int msecs);
+
+    //! @brief Set how transient failures of idempotent requests are retried
+    //!
+    //! GET and PUT requests that time out, lose their connection or are answered with
+    //! 408, 429, 502, 503 or 504 are sent again after an exponentially growing delay with random
+    //! jitter. A \c Retry-After header of the response takes precedence over the computed delay.
+    //! Retries draw from a budget that is refilled by successful requests, so a server that keeps
+    //! failing sees roughly one retry per ten requests instead of a multiple of its load.
+    //!
+    //! @param maxRetries     Maximum number of retries per request (default: 3); 0 disables retries
+    //! @param baseDelayMsecs Delay before the first retry (default: 500 ms)
+    //! @param maxDelayMsecs  Upper bound of the delay (default: 30 s)
+    void setRetryPolicy (int maxRetries, int baseDelayMsecs = 500, int maxDelayMsecs = 30000);
+
+    //! @brief Check whether a reply was aborted because its request timed out
+    //!
+    //! @param reply Network reply passed to a callback
+    //!
+    //! @return true if the request ran out of time, false otherwise
+    static bool isTimedOut (const QNetworkReply* reply);
+
+    //! @brief Set the size budget of the persistent cache
+    //! @param bytes Maximum size in bytes per Redmine server and user (default: 10 MiB)
+    void setDiskCacheSize (qint64 bytes);
+
     /// @}
 
     /// @name Redmine data creators
@@ -117,10 +284,14 @@ public:
     //! @param callback Callback function with a QJsonDocument object
     //! @param id Custom field ID to update; if set to \c NULL_ID, create a new custom field
     //! @param parameters  Additional custom field parameters
-    void sendCustomField (const QJsonDocument& data,
-                          JsonCb callback = nullptr,
-                          int id = NULL_ID,
-                          const QString& parameters = "" );
+    //! @param priority Scheduling priority of the request
+    //!
+    //! @return Handle to cancel the request
+    RequestHandle sendCustomField (const QJsonDocument& data,
+                                   JsonCb callback = nullptr,
+                                   int id = NULL_ID,
+                                   const QString& parameters = "",
+                                   RequestPriority priority = RequestPriority::Interactive );
 
     //! @brief Create or update issue in Redmine
     //!
@@ -128,10 +299,14 @@ public:
     //! @param callback Callback function with a QJsonDocument object
     //! @param id Issue ID to update; if set to \c NULL_ID, create a new issue
     //! @param parameters  Additional issue parameters
-    void sendIssue (const QJsonDocument& data,
-                    JsonCb callback = nullptr,
-                    int id = NULL_ID,
-                    const QString& parameters = "" );
+    //! @param priority Scheduling priority of the request
+    //!
+    //! @return Handle to cancel the request
+    RequestHandle sendIssue (const QJsonDocument& data,
+                             JsonCb callback = nullptr,
+                             int id = NULL_ID,
+                             const QString& parameters = "",
+                             RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Create or update issue category in Redmine
@@ -140,11 +315,15 @@ public:
      * @param callback Callback function with a QJsonDocument object
      * @param id Issue category ID to update; if set to \c NULL_ID, create a new issue category
      * @param parameters  Additional issue category parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void sendIssueCategory( const QJsonDocument& data,
-                            JsonCb callback = nullptr,
-                            const int id = NULL_ID,
-                            const QString& parameters = "" );
+    RequestHandle sendIssueCategory( const QJsonDocument& data,
+                                     JsonCb callback = nullptr,
+                                     const int id = NULL_ID,
+                                     const QString& parameters = "",
+                                     RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Create or update issue priority in Redmine
@@ -153,11 +332,15 @@ public:
      * @param callback Callback function with a QJsonDocument object
      * @param id Issue priority ID to update; if set to \c NULL_ID, create a new issue priority
      * @param parameters  Additional enumeration parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void sendIssuePriority( const QJsonDocument& data,
-                            JsonCb callback = nullptr,
-                            const int id = NULL_ID,
-                            const QString& parameters = "" );
+    RequestHandle sendIssuePriority( const QJsonDocument& data,
+                                     JsonCb callback = nullptr,
+                                     const int id = NULL_ID,
+                                     const QString& parameters = "",
+                                     RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Create or update issue status in Redmine
@@ -166,11 +349,15 @@ public:
      * @param callback Callback function with a QJsonDocument object
      * @param id Issue status ID to update; if set to \c NULL_ID, create a new issue status
      * @param parameters  Additional issue status parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void sendIssueStatus( const QJsonDocument& data,
-                          JsonCb callback = nullptr,
-                          const int id = NULL_ID,
-                          const QString& parameters = "" );
+    RequestHandle sendIssueStatus( const QJsonDocument& data,
+                                   JsonCb callback = nullptr,
+                                   const int id = NULL_ID,
+                                   const QString& parameters = "",
+                                   RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Create or update project in Redmine
@@ -179,11 +366,15 @@ public:
      * @param callback Callback function with a QJsonDocument object
      * @param id Project ID to update; if set to \c NULL_ID, create a new project
      * @param parameters  Additional project parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void sendProject( const QJsonDocument& data,
-                      JsonCb callback = nullptr,
-                      const int id = NULL_ID,
-                      const QString& parameters = "" );
+    RequestHandle sendProject( const QJsonDocument& data,
+                               JsonCb callback = nullptr,
+                               const int id = NULL_ID,
+                               const QString& parameters = "",
+                               RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Create or update time entry in Redmine
@@ -192,11 +383,15 @@ public:
      * @param callback Callback function with a QJsonDocument object
      * @param id Time entry ID to update; if set to \c NULL_ID, create a new time entry
      * @param parameters  Additional time entry parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void sendTimeEntry( const QJsonDocument& data,
-                        JsonCb callback = nullptr,
-                        const int id = NULL_ID,
-                        const QString& parameters = "" );
+    RequestHandle sendTimeEntry( const QJsonDocument& data,
+                                 JsonCb callback = nullptr,
+                                 const int id = NULL_ID,
+                                 const QString& parameters = "",
+                                 RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Create or update time entry activity in Redmine
@@ -205,11 +400,15 @@ public:
      * @param callback Callback function with a QJsonDocument object
      * @param id Time entry activity ID to update; if set to \c NULL_ID, create a new time entry activity
      * @param parameters  Additional enumeration parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void sendTimeEntryActivity( const QJsonDocument& data,
-                                JsonCb callback = nullptr,
-                                const int id = NULL_ID,
-                                const QString& parameters = "" );
+    RequestHandle sendTimeEntryActivity( const QJsonDocument& data,
+                                         JsonCb callback = nullptr,
+                                         const int id = NULL_ID,
+                                         const QString& parameters = "",
+                                         RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Create or update tracker in Redmine
@@ -218,11 +417,15 @@ public:
      * @param callback Callback function with a QJsonDocument object
      * @param id Tracker ID to update; if set to \c NULL_ID, create a new tracker
      * @param parameters  Additional tracker parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void sendTracker( const QJsonDocument& data,
-                      JsonCb callback = nullptr,
-                      const int id = NULL_ID,
-                      const QString& parameters = "" );
+    RequestHandle sendTracker( const QJsonDocument& data,
+                               JsonCb callback = nullptr,
+                               const int id = NULL_ID,
+                               const QString& parameters = "",
+                               RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Create or update user in Redmine
@@ -231,11 +434,15 @@ public:
      * @param callback Callback function with a QJsonDocument object
      * @param id User ID to update; if set to \c NULL_ID, create a new user
      * @param parameters  Additional user parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void sendUser( const QJsonDocument& data,
-                   JsonCb callback = nullptr,
-                   const int id = NULL_ID,
-                   const QString& parameters = "" );
+    RequestHandle sendUser( const QJsonDocument& data,
+                            JsonCb callback = nullptr,
+                            const int id = NULL_ID,
+                            const QString& parameters = "",
+                            RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Create or update version in Redmine
@@ -244,11 +451,15 @@ public:
      * @param callback Callback function with a QJsonDocument object
      * @param id Version ID to update; if set to \c NULL_ID, create a new version
      * @param parameters  Additional version parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void sendVersion( const QJsonDocument& data,
-                      JsonCb callback = nullptr,
-                      const int id = NULL_ID,
-                      const QString& parameters = "" );
+    RequestHandle sendVersion( const QJsonDocument& data,
+                               JsonCb callback = nullptr,
+                               const int id = NULL_ID,
+                               const QString& parameters = "",
+                               RequestPriority priority = RequestPriority::Interactive );
 
     /// @}
 
@@ -260,9 +471,13 @@ public:
      *
      * @param callback Callback function with a QJsonDocument object
      * @param parameters  Additional custom field parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveCustomFields( JsonCb callback,
-                               const QString& parameters = "" );
+    RequestHandle retrieveCustomFields( JsonCb callback,
+                                        const QString& parameters = "",
+                                        RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve an issue from Redmine
@@ -270,18 +485,26 @@ public:
      * @param callback Callback function with a QJsonDocument object
      * @param issueId Issue ID
      * @param parameters  Additional issue parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveIssue( JsonCb callback, const int issueId,
-                        const QString& parameters = "" );
+    RequestHandle retrieveIssue( JsonCb callback, const int issueId,
+                                 const QString& parameters = "",
+                                 RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve issues from Redmine
      *
      * @param callback Callback function with a QJsonDocument object
      * @param parameters  Additional issue parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveIssues( JsonCb callback,
-                         const QString& parameters = "" );
+    RequestHandle retrieveIssues( JsonCb callback,
+                                  const QString& parameters = "",
+                                  RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve issue categories from Redmine
@@ -289,28 +512,40 @@ public:
      * @param callback Callback function with a QJsonDocument object
      * @param projectId Project ID
      * @param parameters Additional issue category parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveIssueCategories( JsonCb callback,
-                                  const int projectId,
-                                  const QString& parameters = "" );
+    RequestHandle retrieveIssueCategories( JsonCb callback,
+                                           const int projectId,
+                                           const QString& parameters = "",
+                                           RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve issue priorities from Redmine
      *
      * @param callback Callback function with a QJsonDocument object
      * @param parameters  Additional enumeration parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveIssuePriorities( JsonCb callback,
-                                  const QString& parameters = "" );
+    RequestHandle retrieveIssuePriorities( JsonCb callback,
+                                           const QString& parameters = "",
+                                           RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve issue statuses from Redmine
      *
      * @param callback Callback function with a QJsonDocument object
      * @param parameters  Additional issue status parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveIssueStatuses( JsonCb callback,
-                                const QString& parameters = "" );
+    RequestHandle retrieveIssueStatuses( JsonCb callback,
+                                         const QString& parameters = "",
+                                         RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve memberships from Redmine
@@ -318,74 +553,110 @@ public:
      * @param callback Callback function with a QJsonDocument object
      * @param projectId Project ID
      * @param parameters Additional membership parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveMemberships( JsonCb callback,
-                              const int projectId,
-                              const QString& parameters = "" );
+    RequestHandle retrieveMemberships( JsonCb callback,
+                                       const int projectId,
+                                       const QString& parameters = "",
+                                       RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve a project from Redmine
      *
+     * Associations are only returned when asked for, e.g. with \c include=trackers in \p parameters.
+     *
      * @param callback Callback function with a QJsonDocument object
      * @param projectId Project ID
      * @param parameters  Additional project parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveProject( JsonCb callback, const int projectId,
-                          const QString& parameters = "" );
+    RequestHandle retrieveProject( JsonCb callback, const int projectId,
+                                   const QString& parameters = "",
+                                   RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve projects from Redmine
      *
+     * Associations are only returned when asked for, e.g. with \c include=trackers in \p parameters.
+     *
      * @param callback Callback function with a QJsonDocument object
      * @param parameters  Additional project parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveProjects( JsonCb callback,
-                           const QString& parameters = "" );
+    RequestHandle retrieveProjects( JsonCb callback,
+                                    const QString& parameters = "",
+                                    RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve time entries from Redmine
      *
      * @param callback Callback function with a QJsonDocument object
      * @param parameters  Additional time entry parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveTimeEntries( JsonCb callback,
-                              const QString& parameters = "" );
+    RequestHandle retrieveTimeEntries( JsonCb callback,
+                                       const QString& parameters = "",
+                                       RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve time entry activities from Redmine
      *
      * @param callback Callback function with a QJsonDocument object
      * @param parameters  Additional enumeration parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveTimeEntryActivities( JsonCb callback,
-                                      const QString& parameters = "" );
+    RequestHandle retrieveTimeEntryActivities( JsonCb callback,
+                                               const QString& parameters = "",
+                                               RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve trackers from Redmine
      *
      * @param callback Callback function with a QJsonDocument object
      * @param parameters  Additional tracker parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveTrackers( JsonCb callback,
-                           const QString& parameters = "" );
+    RequestHandle retrieveTrackers( JsonCb callback,
+                                    const QString& parameters = "",
+                                    RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve current user from Redmine
      *
      * @param callback Callback function with a QJsonDocument object
      * @param parameters  Additional user parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveCurrentUser( JsonCb callback,
-                              const QString& parameters = "" );
+    RequestHandle retrieveCurrentUser( JsonCb callback,
+                                       const QString& parameters = "",
+                                       RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve users from Redmine
      *
      * @param callback Callback function with a QJsonDocument object
      * @param parameters  Additional user parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveUsers( JsonCb callback,
-                        const QString& parameters = "" );
+    RequestHandle retrieveUsers( JsonCb callback,
+                                 const QString& parameters = "",
+                                 RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve a version from Redmine
@@ -393,9 +664,13 @@ public:
      * @param callback Callback function with a QJsonDocument object
      * @param versionId Version ID
      * @param parameters  Additional version parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveVersion( JsonCb callback, const int versionId,
-                          const QString& parameters = "" );
+    RequestHandle retrieveVersion( JsonCb callback, const int versionId,
+                                   const QString& parameters = "",
+                                   RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve versions from Redmine
@@ -403,10 +678,14 @@ public:
      * @param callback Callback function with a QJsonDocument object
      * @param projectId Project ID
      * @param parameters  Additional version parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveVersions( JsonCb callback,
-                           const int projectId,
-                           const QString& parameters = "" );
+    RequestHandle retrieveVersions( JsonCb callback,
+                                    const int projectId,
+                                    const QString& parameters = "",
+                                    RequestPriority priority = RequestPriority::Interactive );
 
     /// @}
 
@@ -414,6 +693,9 @@ protected:
     /**
      * @brief Send a request to Redmine
      *
+     * May be called from any thread. The callback is called on the thread of the callback context,
+     * see setCallbackContext(), or else on the calling thread.
+     *
      * @param resource
      *   @parblock
      *     The resource specific part of the Redmine REST URL, e.g. \c issues or \c projects
@@ -444,14 +726,68 @@ protected:
      *
      * @param postData Data that will be sent by POST and PUT operations
      *
-     * @return The network reply for this request
+     * @param priority Scheduling priority of the request
+     *
+     * @param reader Incremental decoder; if set, the callback receives the envelope of the response,
+     *               and the response bypasses caching and coalescing
+     *
+     * @return Handle to cancel the request, invalid if the request was rejected. From another thread
+     *         than the client's, the request is queued without waiting and a valid handle is
+     *         returned; a rejection is then reported to the callback as a failed reply.
      */
-    QNetworkReply* sendRequest( const QString& resource,
-                                JsonCb callback = nullptr,
-                                const QNetworkAccessManager::Operation mode
-                                = QNetworkAccessManager::GetOperation,
-                                const QString& queryParams = "",
-                                const QByteArray& postData = "" );
+    RequestHandle sendRequest( const QString& resource,
+                               JsonCb callback = nullptr,
+                               const QNetworkAccessManager::Operation mode
+                               = QNetworkAccessManager::GetOperation,
+                               const QString& queryParams = "",
+                               const QByteArray& postData = "",
+                               RequestPriority priority = RequestPriority::Interactive,
+                               QSharedPointer<JsonStreamReader> reader = {} );
+
+    /**
+     * @brief Send a GET request and decode the response on the thread pool
+     *
+     * \c decode turns the reply into typed data off the callback's thread. The call it returns is
+     * made on the thread sendRequest() would call back on, unless the request has been cancelled in
+     * the meantime.
+     *
+     * @param resource    Redmine resource, e.g. \c trackers
+     * @param decode      Decoder, called on a worker thread with the reply and its document
+     * @param queryParams Query parameters that are appended to the Redmine REST URL
+     * @param priority    Scheduling priority of the request
+     *
+     * @return Handle to cancel the request, invalid if the request was rejected; see sendRequest()
+     */
+    RequestHandle decodeRequest( const QString& resource,
+                                 DecodeCb decode,
+                                 const QString& queryParams = "",
+                                 RequestPriority priority = RequestPriority::Interactive );
+
+    /**
+     * @brief Send a GET request and decode the response while it is downloading
+     *
+     * Each element of the array member \c arrayKey is handed to \c element as soon as it has been
+     * received. No document of the whole response is built.
+     *
+     * \c element is called on a worker thread, one element after the other; \c callback is called on
+     * the thread of the client after the last element has been decoded.
+     *
+     * @param resource    Redmine resource, e.g. \c issues
+     * @param arrayKey    Name of the array member to stream, usually the same as \c resource
+     * @param element     Callback function for every array element
+     * @param callback    Callback function called once at the end with the envelope of the response,
+     *                    i.e. everything but the array elements, such as \c total_count or \c errors
+     * @param queryParams Query parameters that are appended to the Redmine REST URL
+     * @param priority    Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
+     */
+    RequestHandle streamRequest( const QString& resource,
+                                 const QByteArray& arrayKey,
+                                 JsonStreamReader::ElementCb element,
+                                 JsonCb callback,
+                                 const QString& queryParams = "",
+                                 RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Create or update enumeration in Redmine
@@ -461,12 +797,16 @@ protected:
      * @param callback Callback function with a QJsonDocument object
      * @param id Enumeration to update; if set to \c NULL_ID, create a enumeration
      * @param parameters Additional enumeration parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void sendEnumeration( const QString& enumeration,
-                          const QJsonDocument& data,
-                          JsonCb callback = nullptr,
-                          const int id = NULL_ID,
-                          const QString& parameters = "" );
+    RequestHandle sendEnumeration( const QString& enumeration,
+                                   const QJsonDocument& data,
+                                   JsonCb callback = nullptr,
+                                   const int id = NULL_ID,
+                                   const QString& parameters = "",
+                                   RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve enumerations from Redmine
@@ -474,10 +814,14 @@ protected:
      * @param enumeration The enumeration to load
      * @param callback    Callback function with a QJsonDocument object
      * @param parameters  Additional enumeration parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveEnumerations( const QString& enumeration,
-                               JsonCb  callback,
-                               const QString& parameters = "" );
+    RequestHandle retrieveEnumerations( const QString& enumeration,
+                                        JsonCb  callback,
+                                        const QString& parameters = "",
+                                        RequestPriority priority = RequestPriority::Interactive );
 
 private:
     /// Currently configured authenticator for Redmine
@@ -492,8 +836,38 @@ private:
     /// Currently configured password
     QString authPassword_;
 
+    /// Validators and decoded body of a previous GET response
+    struct ConditionalEntry
+    {
+        QByteArray etag;         ///< \c ETag response header
+        QByteArray lastModified; ///< \c Last-Modified response header
+        QJsonDocument json;      ///< Decoded response body
+    };
+
+    /// Bookkeeping for a request that waits for its reply
+    struct PendingRequest
+    {
+        QMap<quint64, JsonCb> callbacks; ///< Callbacks of all requests sharing the reply, by request ID
+        QString cacheKey;      ///< Cache key of GET requests, empty otherwise
+        QJsonDocument cached;  ///< Document to replay on <tt>304 Not Modified</tt>
+        bool persistent;       ///< Store the response in the persistent cache
+        bool revalidating;     ///< The callback has already been answered from the persistent cache
+        QByteArray cachedBody; ///< Body answered from the persistent cache, to detect changes
+        QByteArray received;   ///< Streamed body received so far, to store in the persistent cache
+
+        QNetworkRequest request;                 ///< Network request
+        QNetworkAccessManager::Operation mode;   ///< HTTP operation mode
+        QByteArray postData;                     ///< Data sent by POST and PUT operations
+        RequestPriority priority;                ///< Scheduling priority
+        QNetworkReply* reply;                    ///< Running reply, nullptr while queued
+        int retries;                             ///< Number of times the request has been retried
+        bool cancelled;                          ///< All callers cancelled while waiting for a retry
+        QSharedPointer<JsonStreamReader> reader; ///< Incremental decoder of a streamed response
+        QFuture<void> decoding;                  ///< Last decoding step queued on the thread pool
+    };
+
     /**
-     * @brief Mapping from network reply to callback function
+     * @brief Mapping from network reply to pending request
      *
      * This map can be used to find the correct callback for a network reply.
      * It is used by slot replyFinished() to call the desired callback function after
@@ -501,7 +875,73 @@ private:
      *
      * A QMap is usually faster than a QHash for less than 20 elements.
      */
-    QMap<QNetworkReply*, JsonCb> callbacks_;
+    QMap<QNetworkReply*, PendingRequest*> callbacks_;
+
+    /**
+     * @brief Queued and running GET requests by cache key
+     *
+     * Identical GET requests attach to the pending request instead of starting a new one, so the
+     * response is downloaded and decoded only once for all callbacks.
+     */
+    QHash<QString, PendingRequest*> _inFlightGets;
+
+    /// Pending requests by request ID
+    QHash<quint64, PendingRequest*> _requestsById;
+
+    /// ID of the next request
+    QAtomicInteger<quint64> _nextRequestId {1};
+
+    /// Requests waiting for a free slot, one queue per priority class
+    QQueue<PendingRequest*> _queues[REQUEST_PRIORITY_COUNT];
+
+    /// Number of running requests per host
+    QHash<QString, int> _runningPerHost;
+
+    /// Maximum number of running requests per host
+    int _maxRequestsPerHost {6};
+
+    /// Time in milliseconds after which a request without progress is aborted, 0 for none
+    int _requestTimeout {30 * 1000};
+
+    /// Maximum number of retries per request
+    int _maxRetries {3};
+
+    /// Delay before the first retry in milliseconds
+    int _retryBaseDelay {500};
+
+    /// Upper bound of the retry delay in milliseconds
+    int _retryMaxDelay {30 * 1000};
+
+    /// Available retries; every retry takes one, every successful request adds a tenth
+    double _retryTokens {10};
+
+    /// HTTP transport
+    TransportMode _transportMode {TransportMode::Standard};
+
+    /// Protocol of the last successful request per host
+    QHash<QString, QString> _protocols;
+
+    /// Validators of previous GET responses by cache key, with the body size in KiB as cost
+    QCache<QString, ConditionalEntry> _validators {8 * 1024};
+
+    /// Send conditional GET requests
+    bool _conditionalRequests {true};
+
+    /// Persistent response cache
+    ResponseCache _diskCache;
+
+    /// Use the persistent response cache
+    bool _diskCacheEnabled {true};
+
+    /// Time to live in seconds of persistently cached resources
+    QMap<QString, int> _cachePolicies {
+        {"enumerations/issue_priorities",       60 * 60},
+        {"enumerations/time_entry_activities",  60 * 60},
+        {"issue_statuses",                      60 * 60},
+        {"projects",                            5 * 60},
+        {"shared/custom_fields",                60 * 60},
+        {"trackers",                            60 * 60},
+    };
 
     /// Determines whether SSL data (e.g. certificate validity) should be checked
     bool checkSsl_ = true;
@@ -512,6 +952,25 @@ private:
     /// Redmine base URL
     QString _url;
 
+    /// Guards \c _url and \c _protocols, which the getters read from other threads; the client's
+    /// thread reads them without it, as it is the only writer
+    mutable QMutex _stateMutex;
+
+    /// Origin of the last pre-connect
+    QString _preconnectedOrigin;
+
+    /// Time of the last pre-connect
+    QDateTime _preconnectedOn;
+
+    /// Worker threads decoding response bodies
+    QThreadPool _decoderPool;
+
+    /// Internal network thread, nullptr in ThreadMode::OwnerThread
+    QThread* _networkThread {nullptr};
+
+    /// Object on whose thread callbacks are called, nullptr for the sending thread
+    QAtomicPointer<QObject> _callbackContext;
+
     /// User agent for Redmine connection (default: "qtredmine")
     QByteArray _userAgent = "qtredmine";
 
@@ -522,6 +981,168 @@ private:
      */
     void init();
 
+    /**
+     * @brief Get a hash identifying the configured credentials
+     *
+     * @return Hex encoded hash of the API key or login, empty without authenticator
+     */
+    QString authIdentity () const;
+
+    /**
+     * @brief Get the cache key for a request URL
+     *
+     * The key consists of the authentication identity and the URL with its query items sorted and
+     * empty items removed, so equivalent requests map to the same key.
+     *
+     * @param url Request URL
+     *
+     * @return Cache key
+     */
+    QString cacheKey (const QUrl& url) const;
+
+    /**
+     * @brief Point the persistent cache to the directory of the current server and user
+     */
+    void updateDiskCacheDirectory ();
+
+    /**
+     * @brief Start queued requests while their host has free slots
+     */
+    void dispatchRequests ();
+
+    /**
+     * @brief Hand a request to the network access manager
+     *
+     * @param pending Request to start
+     */
+    void startRequest (PendingRequest* pending);
+
+    /**
+     * @brief Cancel a request
+     *
+     * Drops the callback of the request. If no other caller waits for the same response, the
+     * request is removed from the queue or its reply is aborted.
+     *
+     * @param id Request ID
+     */
+    void cancelRequest (quint64 id);
+
+    /**
+     * @brief Forget and delete a pending request
+     *
+     * @param pending Request to delete
+     */
+    void releaseRequest (PendingRequest* pending);
+
+    /**
+     * @brief Send a failed request again if the failure is transient
+     *
+     * If the request is retried, it is removed from the running requests and queued again once its
+     * backoff delay has passed.
+     *
+     * @param reply Finished network reply
+     *
+     * @return true if the request will be retried, false if the reply is final
+     */
+    bool retryRequest (QNetworkReply* reply);
+
+    /**
+     * @brief Send a conditional request again without validators if there is nothing to replay
+     *
+     * A <tt>304 Not Modified</tt> answer is only usable with a previously decoded document. Without
+     * one it is treated as a cache miss: the validators are dropped and the request is queued again
+     * as a plain GET.
+     *
+     * @param reply Finished network reply
+     *
+     * @return true if the request will be sent again, false if the reply is final
+     */
+    bool refetchUncached (QNetworkReply* reply);
+
+    /**
+     * @brief Get the object on whose thread callbacks are called
+     *
+     * @return Callback context, or else an object of the calling thread
+     */
+    QObject* callbackReceiver () const;
+
+    /**
+     * @brief Queue a request from any thread, see queueRequest() for the parameters
+     *
+     * A request from another thread is forwarded without waiting; if it is rejected there,
+     * \c guarded is called with a failed reply.
+     *
+     * @return \c handle, or an invalid handle if the request was rejected on the client's thread
+     */
+    RequestHandle submitRequest (const RequestHandle& handle, JsonCb guarded, const QString& resource,
+                                 const QNetworkAccessManager::Operation mode, const QString& queryParams,
+                                 const QByteArray& postData, RequestPriority priority,
+                                 QSharedPointer<JsonStreamReader> reader);
+
+    /**
+     * @brief Queue a request on the thread of the client
+     *
+     * @param handle   Handle of the request
+     * @param guarded  Callback that checks for cancellation and calls back on the right thread
+     * @param resource Redmine resource
+     * @param mode     HTTP operation mode
+     * @param queryParams Query parameters that are appended to the Redmine REST URL
+     * @param postData Data sent by POST and PUT operations
+     * @param priority Scheduling priority of the request
+     * @param reader   Incremental decoder for streamed responses, null otherwise
+     *
+     * @return true if the request was accepted, false otherwise
+     */
+    bool queueRequest (const RequestHandle& handle, JsonCb guarded, const QString& resource,
+                       const QNetworkAccessManager::Operation mode, const QString& queryParams,
+                       const QByteArray& postData, RequestPriority priority,
+                       QSharedPointer<JsonStreamReader> reader);
+
+    /**
+     * @brief Make a call on the thread of the client if called from another thread
+     *
+     * Public methods start with this, so that the client's state is only touched by its own thread.
+     * The call is queued and the calling thread does not wait for it, so it has to carry its data by
+     * value and report results through callbacks.
+     *
+     * @param call Call to make
+     *
+     * @return true if the call has been forwarded, false if the caller is on the client's thread
+     */
+    bool forwardToClientThread (const std::function<void()>& call) const;
+
+    /**
+     * @brief Stop and delete the network thread
+     */
+    void stopNetworkThread ();
+
+    /**
+     * @brief Run a decoding step of a request on the thread pool
+     *
+     * The steps of one request run one after the other in the order they were queued, so a streamed
+     * response is decoded chunk by chunk.
+     *
+     * @param pending Request the step belongs to
+     * @param step    Decoding step; it must not touch the client
+     */
+    void queueDecoding (PendingRequest* pending, std::function<void()> step);
+
+    /**
+     * @brief Remember the protocol a reply was transferred with
+     *
+     * @param reply Successful network reply
+     */
+    void recordProtocol (QNetworkReply* reply);
+
+    /**
+     * @brief Map a request priority to the network request priority
+     *
+     * @param priority Request priority
+     *
+     * @return Network request priority
+     */
+    static QNetworkRequest::Priority networkPriority (RequestPriority priority);
+
 signals:
     /**
      * @brief Signal that the request has finished
@@ -544,6 +1165,21 @@ signals:
      */
     void initialised();
 
+    /**
+     * @brief Signal that the Redmine URL or the authenticator has changed
+     *
+     * Data loaded before may belong to another server or user from now on.
+     */
+    void identityChanged();
+
+    /**
+     * @brief Signal that a different protocol is used for a host
+     *
+     * @param host     Host name
+     * @param protocol Protocol as returned by negotiatedProtocol()
+     */
+    void protocolNegotiated( const QString& host, const QString& protocol );
+
 private slots:
     /**
      * @brief Handle SSL errors
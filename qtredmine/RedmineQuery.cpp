@@ -0,0 +1,203 @@
+#include "RedmineQuery.h"
+
+#include <QtCore/QUrl>
+
+#include <algorithm>
+
+using namespace qtredmine;
+
+/// Characters left unencoded in parameter values, as Redmine uses them to separate values
+static const QByteArray VALUE_SEPARATORS = ",|*";
+
+/**
+ * @brief Format a time as used by Redmine filters
+ *
+ * @param time Time
+ *
+ * @return Time in UTC, e.g. \c 2024-01-31T12:00:00Z
+ */
+static QString
+filterTime (const QDateTime& time)
+{
+    return time.toUTC ().toString ("yyyy-MM-ddTHH:mm:ss'Z'");
+}
+
+RedmineQuery::RedmineQuery ()
+{}
+
+void
+RedmineQuery::addAlternative (const QString& key, const QString& value)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    QStringList values = _parameters.value (key).split ('|', Qt::SkipEmptyParts);
+#else
+    QStringList values = _parameters.value (key).split ('|', QString::SkipEmptyParts);
+#endif
+
+    if (!values.contains (value)) {
+        values.append (value);
+        std::sort (values.begin (), values.end ());
+    }
+
+    _parameters[key] = values.join ('|');
+}
+
+RedmineQuery&
+RedmineQuery::project (int projectId)
+{
+    addAlternative ("project_id", QString::number (projectId));
+    return *this;
+}
+
+RedmineQuery&
+RedmineQuery::status (int statusId)
+{
+    // Redmine cannot combine a status filter with status IDs, so the filter is replaced
+    QString current = _parameters.value ("status_id");
+    if (current == "open" || current == "closed" || current == "*")
+        _parameters.remove ("status_id");
+
+    addAlternative ("status_id", QString::number (statusId));
+    return *this;
+}
+
+RedmineQuery&
+RedmineQuery::status (StatusFilter filter)
+{
+    switch (filter)
+    {
+    case Open:   _parameters["status_id"] = "open";   break;
+    case Closed: _parameters["status_id"] = "closed"; break;
+    case Any:    _parameters["status_id"] = "*";      break;
+    }
+
+    return *this;
+}
+
+RedmineQuery&
+RedmineQuery::tracker (int trackerId)
+{
+    addAlternative ("tracker_id", QString::number (trackerId));
+    return *this;
+}
+
+RedmineQuery&
+RedmineQuery::assignedTo (int userId)
+{
+    addAlternative ("assigned_to_id", QString::number (userId));
+    return *this;
+}
+
+RedmineQuery&
+RedmineQuery::assignedToMe ()
+{
+    addAlternative ("assigned_to_id", "me");
+    return *this;
+}
+
+RedmineQuery&
+RedmineQuery::updatedOn (const QDateTime& from, const QDateTime& to)
+{
+    if (from.isValid () && to.isValid ())
+        _parameters["updated_on"] = "><" + filterTime (from) + "|" + filterTime (to);
+    else if (from.isValid ())
+        _parameters["updated_on"] = ">=" + filterTime (from);
+    else if (to.isValid ())
+        _parameters["updated_on"] = "<=" + filterTime (to);
+    else
+        _parameters.remove ("updated_on");
+
+    return *this;
+}
+
+RedmineQuery&
+RedmineQuery::sort (const QString& column, Qt::SortOrder order)
+{
+    // A column only counts once, with its first order
+    for (const QString &sort : _sort)
+        if (sort.section (':', 0, 0) == column)
+            return *this;
+
+    _sort.append (order == Qt::DescendingOrder ? column + ":desc" : column);
+    return *this;
+}
+
+RedmineQuery&
+RedmineQuery::clearSort ()
+{
+    _sort.clear ();
+    return *this;
+}
+
+RedmineQuery&
+RedmineQuery::include (const QString& association)
+{
+    if (!_includes.contains (association)) {
+        _includes.append (association);
+        std::sort (_includes.begin (), _includes.end ());
+    }
+
+    return *this;
+}
+
+RedmineQuery&
+RedmineQuery::limit (int limit)
+{
+    _limit = qMax (0, limit);
+    return *this;
+}
+
+RedmineQuery&
+RedmineQuery::set (const QString& key, const QString& value)
+{
+    if (value.isEmpty ())
+        _parameters.remove (key);
+    else
+        _parameters[key] = value;
+
+    return *this;
+}
+
+int
+RedmineQuery::limit () const
+{
+    return _limit;
+}
+
+QString
+RedmineQuery::toString () const
+{
+    QMap<QString, QString> parameters = _parameters;
+
+    if (!_sort.isEmpty ())
+        parameters["sort"] = _sort.join (',');
+    if (!_includes.isEmpty ())
+        parameters["include"] = _includes.join (',');
+
+    // QMap iterates in key order
+    QStringList items;
+    for (auto it = parameters.constBegin (); it != parameters.constEnd (); ++it)
+        items.append (QUrl::toPercentEncoding (it.key ()) + "="
+                      + QUrl::toPercentEncoding (it.value (), VALUE_SEPARATORS));
+
+    return items.join ('&');
+}
+
+QString
+RedmineQuery::page (const QString& parameters, int offset, int limit)
+{
+    // Appended rather than filled in with arg(), which would take the %XX escapes of the parameters
+    // for placeholders
+    QString query = parameters;
+    if (!query.isEmpty ())
+        query += '&';
+    return query + "offset=" + QString::number (offset) + "&limit=" + QString::number (limit);
+}
+
+QDebug
+qtredmine::operator<< (QDebug debug, const RedmineQuery& query)
+{
+    QDebugStateSaver saver (debug);
+    debug.nospace () << "RedmineQuery(" << query.toString () << ", limit " << query.limit () << ")";
+    return debug;
+}
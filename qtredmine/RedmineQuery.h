@@ -0,0 +1,155 @@
+#ifndef REDMINE_QUERY_H
+#define REDMINE_QUERY_H
+
+#include <QtCore/QDateTime>
+#include <QtCore/QDebug>
+#include <QtCore/QMap>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+namespace qtredmine {
+
+//!
+//! @brief Typed query parameters of a Redmine list request
+//!
+//! The filters are evaluated by the server, so only matching resources are transferred, e.g.
+//! @code
+//! RedmineQuery ().project (2).status (RedmineQuery::Open).sort ("updated_on", Qt::DescendingOrder)
+//! @endcode
+//!
+//! Calling a filter several times selects resources matching any of the values, e.g. two calls of
+//! tracker() yield <tt>tracker_id=1|2</tt>. toString() returns the parameters in a canonical form:
+//! equal queries produce the same string, regardless of the order in which they were built.
+//!
+class RedmineQuery
+{
+public:
+    /// Issue status filters besides a single status
+    enum StatusFilter {
+        Open,   ///< All open statuses (the server's default)
+        Closed, ///< All closed statuses
+        Any,    ///< Open and closed statuses
+    };
+
+    //! @brief Constructor for a query without parameters
+    RedmineQuery ();
+
+    //! @brief Select resources of a project
+    //! @param projectId Project ID
+    //! @return This query
+    RedmineQuery& project (int projectId);
+
+    //! @brief Select issues with a status
+    //!
+    //! Replaces a filter set by status(StatusFilter); further status IDs are added as alternatives.
+    //!
+    //! @param statusId Issue status ID
+    //! @return This query
+    RedmineQuery& status (int statusId);
+
+    //! @brief Select issues with open, closed or any status
+    //!
+    //! Replaces the status IDs and any previous filter, as the server cannot combine them.
+    //!
+    //! @param filter Status filter
+    //! @return This query
+    RedmineQuery& status (StatusFilter filter);
+
+    //! @brief Select issues of a tracker
+    //! @param trackerId Tracker ID
+    //! @return This query
+    RedmineQuery& tracker (int trackerId);
+
+    //! @brief Select issues assigned to a user or group
+    //! @param userId User or group ID
+    //! @return This query
+    RedmineQuery& assignedTo (int userId);
+
+    //! @brief Select issues assigned to the authenticated user
+    //! @return This query
+    RedmineQuery& assignedToMe ();
+
+    //! @brief Select resources updated within a time range
+    //!
+    //! @param from Earliest update time; invalid for no lower bound
+    //! @param to   Latest update time; invalid for no upper bound
+    //!
+    //! @return This query
+    RedmineQuery& updatedOn (const QDateTime& from, const QDateTime& to = QDateTime ());
+
+    //! @brief Sort by a column; further calls add secondary sort columns
+    //!
+    //! @param column Column name, e.g. \c updated_on or \c priority
+    //! @param order  Sort order
+    //!
+    //! @return This query
+    RedmineQuery& sort (const QString& column, Qt::SortOrder order = Qt::AscendingOrder);
+
+    //! @brief Remove all sort columns
+    //! @return This query
+    RedmineQuery& clearSort ();
+
+    //! @brief Include an association in the response
+    //! @param association Association, e.g. \c journals or \c trackers
+    //! @return This query
+    RedmineQuery& include (const QString& association);
+
+    //! @brief Set the number of resources per response
+    //! @param limit Page size; 0 for the client's default
+    //! @return This query
+    RedmineQuery& limit (int limit);
+
+    //! @brief Set any other parameter, e.g. a custom field filter
+    //!
+    //! @param key   Parameter name, e.g. \c cf_3
+    //! @param value Parameter value; an empty value removes the parameter
+    //!
+    //! @return This query
+    RedmineQuery& set (const QString& key, const QString& value);
+
+    //! @brief Get the page size
+    //! @return Page size, 0 if not set
+    int limit () const;
+
+    //! @brief Get the parameters as canonical query string
+    //!
+    //! The page size is not part of the string, as it is set per page by paginated requests.
+    //!
+    //! @return Percent-encoded query string, e.g. <tt>project_id=2&sort=updated_on%3Adesc</tt>
+    QString toString () const;
+
+    //! @brief Add the page parameters to a query string
+    //!
+    //! @param parameters Percent-encoded query string, e.g. from toString()
+    //! @param offset     Index of the first resource
+    //! @param limit      Page size
+    //!
+    //! @return \c parameters followed by \c offset and \c limit
+    static QString page (const QString& parameters, int offset, int limit);
+
+private:
+    //! @brief Add a value to a parameter whose values are alternatives
+    void addAlternative (const QString& key, const QString& value);
+
+    /// Parameters by name
+    QMap<QString, QString> _parameters;
+
+    /// Sort columns in order of precedence
+    QStringList _sort;
+
+    /// Included associations
+    QStringList _includes;
+
+    /// Page size, 0 if not set
+    int _limit {0};
+};
+
+/**
+ * @brief QDebug stream operator for RedmineQuery
+ * @return QDebug object
+ */
+QDebug operator<< (QDebug debug, const RedmineQuery& query);
+
+} // qtredmine
+
+#endif // REDMINE_QUERY_H
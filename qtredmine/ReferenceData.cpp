@@ -0,0 +1,223 @@
+#include "ReferenceData.h"
+
+using namespace qtredmine;
+
+/// Number of reference data resources
+static const int RESOURCE_COUNT = ReferenceData::CurrentUser + 1;
+
+ReferenceData::ReferenceData (SimpleRedmineClient* client, QObject* parent)
+    : QObject (parent)
+    , _client (client)
+{}
+
+ReferenceData::~ReferenceData ()
+{
+    cancel ();
+}
+
+void
+ReferenceData::setLocalStore (LocalStore* store)
+{
+    _store = store;
+    if (!_store)
+        return;
+
+    for (const Tracker &tracker : _store->trackers ())
+        _trackers.insert (tracker.id, tracker);
+    for (const IssueStatus &status : _store->issueStatuses ())
+        _issueStatuses.insert (status.id, status);
+    for (const Enumeration &issuePriority : _store->issuePriorities ())
+        _issuePriorities.insert (issuePriority.id, issuePriority);
+    for (const Enumeration &activity : _store->timeEntryActivities ())
+        _timeEntryActivities.insert (activity.id, activity);
+    for (const CustomField &customField : _store->customFields ())
+        _customFields.insert (customField.id, customField);
+
+    User user = _store->currentUser ();
+    if (user._id != NULL_ID)
+        _currentUser = user;
+}
+
+void
+ReferenceData::bootstrap (RequestPriority priority)
+{
+    cancel ();
+
+    _errors.clear ();
+    _finished = 0;
+    _running = true;
+
+    // Rejected requests finish right away, so ready() waits until the last request has been sent
+    _launching = true;
+
+    track (Trackers, _client->retrieveTrackers
+           ([this](qtredmine::Trackers trackers, RedmineError redmineError, QStringList errors)
+    {
+        if (redmineError == RedmineError::NO_ERR) {
+            _trackers.clear ();
+            for (const Tracker &tracker : trackers)
+                _trackers.insert (tracker.id, tracker);
+            if (_store)
+                _store->storeTrackers (trackers);
+        }
+        finish (Trackers, redmineError, errors);
+    }, "", priority));
+
+    track (IssueStatuses, _client->retrieveIssueStatuses
+           ([this](qtredmine::IssueStatuses statuses, RedmineError redmineError, QStringList errors)
+    {
+        if (redmineError == RedmineError::NO_ERR) {
+            _issueStatuses.clear ();
+            for (const IssueStatus &status : statuses)
+                _issueStatuses.insert (status.id, status);
+            if (_store)
+                _store->storeIssueStatuses (statuses);
+        }
+        finish (IssueStatuses, redmineError, errors);
+    }, "", priority));
+
+    track (IssuePriorities, _client->retrieveIssuePriorities
+           ([this](Enumerations priorities, RedmineError redmineError, QStringList errors)
+    {
+        if (redmineError == RedmineError::NO_ERR) {
+            _issuePriorities.clear ();
+            for (const Enumeration &issuePriority : priorities)
+                _issuePriorities.insert (issuePriority.id, issuePriority);
+            if (_store)
+                _store->storeIssuePriorities (priorities);
+        }
+        finish (IssuePriorities, redmineError, errors);
+    }, "", priority));
+
+    track (TimeEntryActivities, _client->retrieveTimeEntryActivities
+           ([this](Enumerations activities, RedmineError redmineError, QStringList errors)
+    {
+        if (redmineError == RedmineError::NO_ERR) {
+            _timeEntryActivities.clear ();
+            for (const Enumeration &activity : activities)
+                _timeEntryActivities.insert (activity.id, activity);
+            if (_store)
+                _store->storeTimeEntryActivities (activities);
+        }
+        finish (TimeEntryActivities, redmineError, errors);
+    }, "", priority));
+
+    track (CustomFields, _client->retrieveCustomFields
+           ([this](qtredmine::CustomFields customFields, RedmineError redmineError, QStringList errors)
+    {
+        if (redmineError == RedmineError::NO_ERR) {
+            _customFields.clear ();
+            for (const CustomField &customField : customFields)
+                _customFields.insert (customField.id, customField);
+            if (_store)
+                _store->storeCustomFields (customFields);
+        }
+        finish (CustomFields, redmineError, errors);
+    }, CustomFieldFilter (), priority));
+
+    track (CurrentUser, _client->retrieveCurrentUser
+           ([this](User user, RedmineError redmineError, QStringList errors)
+    {
+        if (redmineError == RedmineError::NO_ERR) {
+            _currentUser = user;
+            if (_store)
+                _store->storeCurrentUser (user);
+        }
+        finish (CurrentUser, redmineError, errors);
+    }, priority));
+
+    _launching = false;
+    checkReady ();
+}
+
+void
+ReferenceData::track (Resource resource, const RequestHandle& handle)
+{
+    if (!handle.isValid ()) {
+        finish (resource, RedmineError::ERR_NETWORK, QStringList () << "Request rejected by the client");
+        return;
+    }
+
+    _request.add (handle);
+}
+
+void
+ReferenceData::finish (Resource resource, RedmineError redmineError, const QStringList& errors)
+{
+    if (redmineError != RedmineError::NO_ERR)
+        qCritical () << "[ReferenceData][finish]" << resource << errors;
+
+    // Cached resources call back again after revalidation; only their first answer counts
+    const int bit = 1 << resource;
+    if (!_running || (_finished & bit))
+        return;
+
+    _finished |= bit;
+    if (redmineError != RedmineError::NO_ERR)
+        _errors[resource] = errors;
+
+    checkReady ();
+}
+
+void
+ReferenceData::checkReady ()
+{
+    if (!_running || _launching || _finished != (1 << RESOURCE_COUNT) - 1)
+        return;
+
+    // The requests are kept, so that revalidations still arriving can be cancelled
+    _running = false;
+    _ready = true;
+    emit ready (_errors);
+}
+
+void
+ReferenceData::cancel ()
+{
+    _request.cancel ();
+    _request = RequestHandle ();
+    _running = false;
+    _launching = false;
+}
+
+bool
+ReferenceData::isReady () const
+{
+    return _ready;
+}
+
+Tracker
+ReferenceData::tracker (int id) const
+{
+    return _trackers.value (id);
+}
+
+IssueStatus
+ReferenceData::issueStatus (int id) const
+{
+    return _issueStatuses.value (id);
+}
+
+Enumeration
+ReferenceData::issuePriority (int id) const
+{
+    return _issuePriorities.value (id);
+}
+
+Enumeration
+ReferenceData::timeEntryActivity (int id) const
+{
+    return _timeEntryActivities.value (id);
+}
+
+CustomField
+ReferenceData::customField (int id) const
+{
+    return _customFields.value (id);
+}
+
+User
+ReferenceData::currentUser () const
+{
+    return _currentUser;
+}
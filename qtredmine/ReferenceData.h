@@ -0,0 +1,163 @@
+#ifndef REFERENCE_DATA_H
+#define REFERENCE_DATA_H
+
+#include "LocalStore.h"
+#include "SimpleRedmineClient.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QObject>
+#include <QtCore/QStringList>
+
+namespace qtredmine {
+
+//!
+//! @brief Registry of the Redmine reference data
+//!
+//! Trackers, issue statuses, issue priorities, time entry activities, custom fields and the current
+//! user rarely change, but are needed to display almost anything. bootstrap() requests all of them at
+//! once and emits ready() when the last one has arrived; afterwards they can be looked up by ID.
+//!
+//! With a local store, the registry starts with the reference data of the last bootstrap, so lookups
+//! work before ready() and while Redmine is not accessible.
+//!
+//! The registry is filled by the client's callbacks, so it has to be used on the thread they are
+//! called on: the thread calling bootstrap(), unless the client has a callback context.
+//!
+class ReferenceData : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// Reference data resources
+    enum Resource {
+        Trackers,            ///< Trackers
+        IssueStatuses,       ///< Issue statuses
+        IssuePriorities,     ///< Issue priorities
+        TimeEntryActivities, ///< Time entry activities
+        CustomFields,        ///< Custom fields
+        CurrentUser,         ///< Authenticated user
+    };
+    Q_ENUM (Resource)
+
+    /// Error messages of the resources that could not be retrieved
+    using Errors = QMap<Resource, QStringList>;
+
+    //! @brief Constructor for an empty registry
+    //!
+    //! @param client Client to retrieve the reference data with
+    //! @param parent Parent QObject
+    explicit ReferenceData (SimpleRedmineClient* client, QObject* parent = nullptr);
+
+    //! @brief Destructor; cancels a running bootstrap
+    virtual ~ReferenceData ();
+
+    //! @brief Set the store keeping the reference data across restarts, and load its contents
+    //! @param store Local store, nullptr to keep the reference data in memory only
+    void setLocalStore (LocalStore* store);
+
+    //! @brief Retrieve all reference data concurrently
+    //!
+    //! A running bootstrap is cancelled. The registry keeps its previous contents until the new ones
+    //! have arrived.
+    //!
+    //! @param priority Scheduling priority of the requests
+    void bootstrap (RequestPriority priority = RequestPriority::Interactive);
+
+    //! @brief Cancel a running bootstrap; ready() is not emitted
+    void cancel ();
+
+    //! @brief Check whether a bootstrap has finished
+    //! @return true if ready() has been emitted at least once, false otherwise
+    bool isReady () const;
+
+    //! @brief Look up a tracker
+    //! @param id Tracker ID
+    //! @return Tracker, or one with ID NULL_ID if unknown
+    Tracker tracker (int id) const;
+
+    //! @brief Look up an issue status
+    //! @param id Issue status ID
+    //! @return Issue status, or one with ID NULL_ID if unknown
+    IssueStatus issueStatus (int id) const;
+
+    //! @brief Look up an issue priority
+    //! @param id Issue priority ID
+    //! @return Issue priority, or one with ID NULL_ID if unknown
+    Enumeration issuePriority (int id) const;
+
+    //! @brief Look up a time entry activity
+    //! @param id Time entry activity ID
+    //! @return Time entry activity, or one with ID NULL_ID if unknown
+    Enumeration timeEntryActivity (int id) const;
+
+    //! @brief Look up a custom field
+    //! @param id Custom field ID
+    //! @return Custom field, or one with ID NULL_ID if unknown
+    CustomField customField (int id) const;
+
+    //! @brief Get the authenticated user
+    //! @return User, or one with ID -1 if unknown
+    User currentUser () const;
+
+signals:
+    //! @brief All requests of a bootstrap have finished; emitted once per bootstrap
+    //!
+    //! Resources with a cache policy may be answered from disk first. Their lookups are updated
+    //! again if the revalidated data differs, without another ready().
+    //!
+    //! @param errors Error messages of the resources that could not be retrieved; empty on success
+    void ready (const qtredmine::ReferenceData::Errors& errors);
+
+private:
+    //! @brief Record the end of a request
+    //!
+    //! @param resource     Resource the request retrieved
+    //! @param redmineError Redmine error
+    //! @param errors       Error messages
+    void finish (Resource resource, RedmineError redmineError, const QStringList& errors);
+
+    //! @brief Emit ready() once every resource of the running bootstrap has been answered
+    void checkReady ();
+
+    //! @brief Add a request to the running bootstrap, or finish it if the client rejected it
+    //! @param resource Resource the request retrieves
+    //! @param handle   Handle returned by the client
+    void track (Resource resource, const RequestHandle& handle);
+
+    /// Client to retrieve the reference data with
+    SimpleRedmineClient* _client {nullptr};
+
+    /// Store keeping the reference data across restarts
+    LocalStore* _store {nullptr};
+
+    /// Requests of the running bootstrap
+    RequestHandle _request;
+
+    /// Resources of the running bootstrap that have been answered, one bit per Resource
+    int _finished {0};
+
+    /// The requests of the running bootstrap are still being sent
+    bool _launching {false};
+
+    /// A bootstrap is running and ready() has not been emitted for it yet
+    bool _running {false};
+
+    /// Errors of the running bootstrap
+    Errors _errors;
+
+    /// A bootstrap has finished
+    bool _ready {false};
+
+    /// Lookup tables by ID
+    QHash<int, Tracker>     _trackers;
+    QHash<int, IssueStatus> _issueStatuses;
+    QHash<int, Enumeration> _issuePriorities;
+    QHash<int, Enumeration> _timeEntryActivities;
+    QHash<int, CustomField> _customFields;
+    User                    _currentUser;
+};
+
+} // qtredmine
+
+#endif // REFERENCE_DATA_H
@@ -0,0 +1,86 @@
+#include "RequestHandle.h"
+#include "RedmineClient.h"
+
+using namespace qtredmine;
+
+RequestHandle::RequestHandle ()
+{}
+
+RequestHandle::RequestHandle (RedmineClient* client, quint64 id)
+    : _state (new State ())
+{
+    _state->client = client;
+    _state->id = id;
+}
+
+bool
+RequestHandle::isValid () const
+{
+    return !_state.isNull ();
+}
+
+bool
+RequestHandle::isCancelled () const
+{
+    return _state && _state->cancelled;
+}
+
+void
+RequestHandle::cancel ()
+{
+    // Handles may be cancelled from several threads at once
+    if (!_state || _state->cancelled.exchange (true))
+        return;
+
+    if (_state->client && _state->id)
+        _state->client->cancelRequest (_state->id);
+
+    // Requests added from now on see the cancelled flag and cancel themselves
+    QVector<QSharedPointer<State>> children;
+    {
+        QMutexLocker locker (&_state->mutex);
+        children.swap (_state->children);
+    }
+
+    for (const QSharedPointer<State> &child : children) {
+        RequestHandle handle;
+        handle._state = child;
+        handle.cancel ();
+    }
+}
+
+void
+RequestHandle::add (const RequestHandle& request)
+{
+    if (!request._state)
+        return;
+
+    // A handle without request becomes a group
+    if (!_state)
+        _state.reset (new State ());
+
+    {
+        // Checked under the lock, so a concurrent cancel() either sees the request or it sees the flag
+        QMutexLocker locker (&_state->mutex);
+        if (!_state->cancelled) {
+            _state->children.append (request._state);
+            return;
+        }
+    }
+
+    RequestHandle (request).cancel ();
+}
+
+QDebug
+qtredmine::operator<< (QDebug debug, const RequestHandle& handle)
+{
+    QDebugStateSaver saver (debug);
+
+    if (!handle._state)
+        debug.nospace () << "RequestHandle()";
+    else
+        debug.nospace () << "RequestHandle(" << handle._state->id
+                         << (handle._state->cancelled ? ", cancelled)" : ")");
+
+    return debug;
+}
@@ -0,0 +1,88 @@
+#ifndef REQUEST_HANDLE_H
+#define REQUEST_HANDLE_H
+
+#include <QtCore/QDebug>
+#include <QtCore/QMutex>
+#include <QtCore/QPointer>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QVector>
+
+#include <atomic>
+
+namespace qtredmine {
+
+class RedmineClient;
+
+//!
+//! @brief Handle to cancel a request
+//!
+//! Handles are cheap to copy; all copies refer to the same request. Cancelling a request drops its
+//! callback and aborts the network reply unless other callers still wait for the same response. A
+//! handle may group several requests, e.g. the pages of a paginated fetch, which are then cancelled
+//! together.
+//!
+//! A default constructed handle refers to no request, as returned when a request was rejected.
+//!
+//! Copies of a handle may be cancelled and added to from several threads at once. The client has to
+//! outlive the handles of its requests, or at least every cancel() running on another thread than
+//! the one deleting the client.
+//!
+class RequestHandle
+{
+public:
+    //! @brief Constructor for a handle without request
+    RequestHandle ();
+
+    //! @brief Check whether the handle refers to a request
+    //! @return true if a request was accepted, false otherwise
+    bool isValid () const;
+
+    //! @brief Check whether the request has been cancelled
+    //! @return true if cancel() has been called, false otherwise
+    bool isCancelled () const;
+
+    //! @brief Cancel the request and all requests added to it
+    //!
+    //! The callbacks are not called afterwards. Cancelling a finished or cancelled request has no
+    //! effect.
+    void cancel ();
+
+    //! @brief Add a request that is cancelled along with this one
+    //!
+    //! If this request has already been cancelled, \c request is cancelled right away.
+    //!
+    //! @param request Request to add
+    void add (const RequestHandle& request);
+
+private:
+    friend class RedmineClient;
+    friend QDebug operator<< (QDebug debug, const RequestHandle& handle);
+
+    /// State shared by all copies of a handle
+    struct State
+    {
+        QPointer<RedmineClient> client;             ///< Client running the request
+        quint64 id {0};                             ///< Request ID, 0 for a group of requests
+        std::atomic<bool> cancelled {false};        ///< The request has been cancelled
+        QMutex mutex;                               ///< Guards children
+        QVector<QSharedPointer<State>> children;    ///< Requests added to this one
+    };
+
+    //! @brief Constructor for a request of a client
+    //! @param client Client running the request
+    //! @param id     Request ID
+    RequestHandle (RedmineClient* client, quint64 id);
+
+    /// Shared state, nullptr for a handle without request
+    QSharedPointer<State> _state;
+};
+
+/**
+ * @brief QDebug stream operator for RequestHandle
+ * @return QDebug object
+ */
+QDebug operator<< (QDebug debug, const RequestHandle& handle);
+
+} // qtredmine
+
+#endif // REQUEST_HANDLE_H
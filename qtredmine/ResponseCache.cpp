@@ -0,0 +1,147 @@
+#include "ResponseCache.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+#include <QtNetwork/QNetworkRequest>
+
+using namespace qtredmine;
+
+/// Magic number and format version of cache files
+static const quint32 CACHE_MAGIC   = 0x51524d43; // "QRMC"
+static const quint32 CACHE_VERSION = 1;
+
+ResponseCache::ResponseCache ()
+{}
+
+void
+ResponseCache::setDirectory (const QString& directory)
+{
+    // Created with the first entry, so that a cache that is never written leaves nothing behind
+    _directory = directory;
+}
+
+QString
+ResponseCache::directory () const
+{
+    return _directory;
+}
+
+void
+ResponseCache::setMaximumSize (qint64 bytes)
+{
+    _maximumSize = bytes;
+    expire ();
+}
+
+QString
+ResponseCache::fileName (const QString& key) const
+{
+    return _directory + "/" + QCryptographicHash::hash (key.toUtf8 (), QCryptographicHash::Sha1).toHex ();
+}
+
+bool
+ResponseCache::lookup (const QString& key, Entry& entry) const
+{
+    if (_directory.isEmpty ())
+        return false;
+
+    QFile file (fileName (key));
+    if (!file.open (QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in (&file);
+    quint32 magic, version;
+    QString storedKey;
+    in >> magic >> version;
+
+    if (magic != CACHE_MAGIC || version != CACHE_VERSION)
+        return false;
+
+    in >> storedKey >> entry.storedOn >> entry.etag >> entry.lastModified >> entry.body;
+
+    // Hash collisions and truncated files are treated as misses
+    return in.status () == QDataStream::Ok && storedKey == key;
+}
+
+void
+ResponseCache::store (const QString& key, Entry entry)
+{
+    if (_directory.isEmpty ())
+        return;
+
+    if (!QDir ().mkpath (_directory)) {
+        qWarning () << "[ResponseCache][store] Cannot create" << _directory;
+        return;
+    }
+
+    entry.storedOn = QDateTime::currentDateTimeUtc ();
+
+    QSaveFile file (fileName (key));
+    if (!file.open (QIODevice::WriteOnly)) {
+        qWarning () << "[ResponseCache][store] Cannot write" << file.fileName ();
+        return;
+    }
+
+    QDataStream out (&file);
+    out << CACHE_MAGIC << CACHE_VERSION
+        << key << entry.storedOn << entry.etag << entry.lastModified << entry.body;
+
+    if (!file.commit ())
+        qWarning () << "[ResponseCache][store] Cannot commit" << file.fileName ();
+
+    expire ();
+}
+
+void
+ResponseCache::touch (const QString& key)
+{
+    Entry entry;
+    if (lookup (key, entry))
+        store (key, entry);
+}
+
+void
+ResponseCache::clear ()
+{
+    if (_directory.isEmpty ())
+        return;
+
+    QDir dir (_directory);
+    for (const QString &name : dir.entryList (QDir::Files))
+        dir.remove (name);
+}
+
+void
+ResponseCache::expire ()
+{
+    if (_directory.isEmpty ())
+        return;
+
+    // Newest files first
+    QFileInfoList files = QDir (_directory).entryInfoList (QDir::Files, QDir::Time);
+
+    qint64 size = 0;
+    for (const QFileInfo &info : files) {
+        size += info.size ();
+        if (size > _maximumSize)
+            QFile::remove (info.filePath ());
+    }
+}
+
+//-----------------------------------------------------------------
+
+CachedReply::CachedReply (const QUrl& url, QObject* parent)
+    : QNetworkReply (parent)
+{
+    setUrl (url);
+    setOperation (QNetworkAccessManager::GetOperation);
+    setAttribute (QNetworkRequest::HttpStatusCodeAttribute, 200);
+    setAttribute (QNetworkRequest::SourceIsFromCacheAttribute, true);
+    setError (QNetworkReply::NoError, QString ());
+    open (QIODevice::ReadOnly);
+    setFinished (true);
+}
@@ -0,0 +1,103 @@
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QDateTime>
+#include <QtCore/QString>
+#include <QtNetwork/QNetworkReply>
+
+namespace qtredmine {
+
+//!
+//! @brief Persistent cache for raw Redmine responses
+//!
+//! Every entry is stored in its own file, named after a hash of the cache key, below a directory
+//! that is chosen per Redmine server and user. The total size of a directory is kept below a
+//! configurable budget by evicting the least recently stored entries.
+//!
+class ResponseCache
+{
+public:
+    /// Cached response
+    struct Entry
+    {
+        QByteArray body;         ///< Raw response body
+        QByteArray etag;         ///< \c ETag response header
+        QByteArray lastModified; ///< \c Last-Modified response header
+        QDateTime  storedOn;     ///< Time the response was stored or last revalidated
+    };
+
+    //! @brief Constructor for a disabled cache
+    ResponseCache ();
+
+    //! @brief Set the directory holding the cache files
+    //! @param directory Cache directory, created when the first entry is stored; an empty string
+    //!                  disables the cache
+    void setDirectory (const QString& directory);
+
+    //! @brief Get the directory holding the cache files
+    //! @return Cache directory, empty if the cache is disabled
+    QString directory () const;
+
+    //! @brief Set the size budget of the cache directory
+    //! @param bytes Maximum size in bytes
+    void setMaximumSize (qint64 bytes);
+
+    //! @brief Look up a cached response
+    //!
+    //! @param key   Cache key
+    //! @param entry Entry to fill
+    //!
+    //! @return true if an entry was found, false otherwise
+    bool lookup (const QString& key, Entry& entry) const;
+
+    //! @brief Store a response
+    //!
+    //! @param key   Cache key
+    //! @param entry Entry to store; \c storedOn is set to the current time
+    void store (const QString& key, Entry entry);
+
+    //! @brief Mark a cached response as revalidated now
+    //! @param key Cache key
+    void touch (const QString& key);
+
+    //! @brief Remove all cached responses from the current directory
+    void clear ();
+
+private:
+    //! @brief Get the file name for a cache key
+    QString fileName (const QString& key) const;
+
+    //! @brief Evict the oldest entries until the directory fits into the size budget
+    void expire ();
+
+    /// Cache directory
+    QString _directory;
+
+    /// Size budget in bytes
+    qint64 _maximumSize {10 * 1024 * 1024};
+};
+
+//!
+//! @brief Network reply for a response answered from a cache
+//!
+//! The reply is finished on construction and carries no body, the decoded document is handed to
+//! the callback directly.
+//!
+class CachedReply : public QNetworkReply
+{
+public:
+    //! @brief Constructor
+    //! @param url    Request URL
+    //! @param parent Parent QObject (default: nullptr)
+    CachedReply (const QUrl& url, QObject* parent = nullptr);
+
+    void abort () override {}
+
+protected:
+    qint64 readData (char*, qint64) override { return -1; }
+};
+
+} // qtredmine
+
+#endif // RESPONSE_CACHE_H
@@ -1,15 +1,23 @@
+#include "FastJsonDecoder.h"
+#include "LocalStore.h"
 #include "Logging.h"
 #include "SimpleRedmineClient.h"
+#include "StringPool.h"
 
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
+#include <QtCore/QSet>
+#include <QtCore/QSharedPointer>
 #include <QtCore/QTimer>
 
 using namespace qtredmine;
 SimpleRedmineClient *SimpleRedmineClient::_instance {nullptr};
 
-// Fill items
+/// Time in seconds that projects loaded by retrieveProjectDetails() are answered from memory
+static const int PROJECT_DETAILS_TTL = 5 * 60;
+
+// Fill items; names repeat across entities and are interned
 void
 fillItem( Item& item, QJsonObject* obj, QString value)
 {
@@ -18,7 +26,7 @@ fillItem( Item& item, QJsonObject* obj, QString value)
     if( !itemObj.isEmpty() )
     {
         item._id   = itemObj.value ("id").toInt ();
-        item._name = itemObj.value ("name").toString ();
+        item._name = StringPool::itemNames ().intern (itemObj.value ("name").toString ());
     }
 }
 
@@ -40,7 +48,7 @@ getErrorList( QNetworkReply* reply, QJsonDocument* json )
 
     QJsonArray jsonErrors = json->object().find("errors").value().toArray();
     QStringList errors;
-    errors.push_back( reply->errorString() );
+    errors.push_back( RedmineClient::isTimedOut( reply ) ? QString( "Request timed out" ) : reply->errorString() );
 
     for( const auto& error : jsonErrors )
         errors.push_back( error.toString() );
@@ -48,6 +56,45 @@ getErrorList( QNetworkReply* reply, QJsonDocument* json )
     RETURN( errors );
 }
 
+RedmineError
+getNetworkError( QNetworkReply* reply )
+{
+    ENTER()(reply->error());
+
+    RedmineError error = RedmineClient::isTimedOut( reply ) ? RedmineError::ERR_TIMEOUT
+                                                            : RedmineError::ERR_NETWORK;
+
+    RETURN( error );
+}
+
+/**
+ * @brief Create a decoder that builds a list on the thread pool
+ *
+ * @param parse    Builds the list from the response document
+ * @param callback Callback function with the list, called on the callback's thread
+ *
+ * @return Decoder for RedmineClient::decodeRequest()
+ */
+template<typename T>
+static RedmineClient::DecodeCb
+listDecoder( std::function<T(QJsonDocument*)> parse, std::function<void(T, RedmineError, QStringList)> callback )
+{
+    return [parse, callback]( QNetworkReply* reply, QJsonDocument* json ) -> std::function<void()>
+    {
+        // Quit on network error
+        if( reply->error() != QNetworkReply::NoError )
+        {
+            qDebug() << "[SimpleRedmineClient][listDecoder] Network error:" << reply->errorString();
+            RedmineError error = getNetworkError( reply );
+            QStringList errors = getErrorList( reply, json );
+            return [callback, error, errors]() { callback( T(), error, errors ); };
+        }
+
+        T items = parse( json );
+        return [callback, items]() { callback( items, RedmineError::NO_ERR, QStringList() ); };
+    };
+}
+
 SimpleRedmineClient::SimpleRedmineClient( QObject* parent )
     : RedmineClient( parent )
 {
@@ -99,13 +146,21 @@ SimpleRedmineClient::init()
     // Connect the initialised signal to the isConnected slot
     connect( this, &SimpleRedmineClient::initialised, [&](){ checkConnectionStatus(); } );
 
+    // Project details of another server or user must not be handed out
+    connect( this, &RedmineClient::identityChanged, this, [this](){ invalidateProjectDetails(); } );
+
     RETURN();
 }
 
 void
 SimpleRedmineClient::checkConnectionStatus()
 {
-    ENTER()(_checkingConnection)(connected_);
+    ENTER();
+
+    if( forwardToClientThread( [=]() { checkConnectionStatus(); } ) )
+        RETURN();
+
+    DEBUG()(_checkingConnection)(connected_);
 
     if( _checkingConnection )
         RETURN();
@@ -145,10 +200,11 @@ SimpleRedmineClient::checkConnectionStatus()
     };
 
     // Try to fetch one issue
-    QNetworkReply* reply = sendRequest( "issues", cb, QNetworkAccessManager::GetOperation, "limit=1" );
+    bool sent = sendRequest( "issues", cb, QNetworkAccessManager::GetOperation, "limit=1", "",
+                             RequestPriority::Prefetch ).isValid();
 
-    if( reply )
-        QTimer::singleShot( 1000, [=](){
+    if( sent )
+        QTimer::singleShot( 1000, this, [=](){
             if( !_checkingConnection )
                 RETURN();
 
@@ -213,7 +269,20 @@ SimpleRedmineClient::reconnect()
 }
 
 void
-SimpleRedmineClient::sendIssue( Issue item, SuccessCb callback, int id, QString parameters )
+SimpleRedmineClient::setDecoder( DecoderBackend decoder )
+{
+    _decoder = decoder;
+}
+
+void
+SimpleRedmineClient::setLocalStore( LocalStore* store )
+{
+    _store = store;
+}
+
+RequestHandle
+SimpleRedmineClient::sendIssue( Issue item, SuccessCb callback, int id, QString parameters,
+                                RequestPriority priority )
 {
     ENTER()(item)(id)(parameters);
 
@@ -297,7 +366,7 @@ SimpleRedmineClient::sendIssue( Issue item, SuccessCb callback, int id, QString
         if( reply->error() != QNetworkReply::NoError )
         {
             DEBUG() << "Network error:" << reply->errorString();
-            callback( false, NULL_ID, RedmineError::ERR_NETWORK, getErrorList(reply, json) );
+            callback( false, NULL_ID, getNetworkError(reply), getErrorList(reply, json) );
             RETURN();
         }
 
@@ -308,13 +377,14 @@ SimpleRedmineClient::sendIssue( Issue item, SuccessCb callback, int id, QString
         callback( true, issueId, RedmineError::NO_ERR, QStringList() );
     };
 
-    RedmineClient::sendIssue( json, cb, id, parameters );
+    RequestHandle handle = RedmineClient::sendIssue( json, cb, id, parameters, priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-SimpleRedmineClient::sendTimeEntry( TimeEntry item, SuccessCb callback, int id, QString parameters )
+RequestHandle
+SimpleRedmineClient::sendTimeEntry( TimeEntry item, SuccessCb callback, int id, QString parameters,
+                                    RequestPriority priority )
 {
     ENTER()(id)(parameters);
 
@@ -322,14 +392,14 @@ SimpleRedmineClient::sendTimeEntry( TimeEntry item, SuccessCb callback, int id,
     {
         DEBUG() << "Time entry has to be at least 0.1 hours (36 seconds)";
         callback( false, NULL_ID, RedmineError::ERR_TIME_ENTRY_TOO_SHORT, QStringList() );
-        RETURN();
+        RETURN( RequestHandle() );
     }
 
     if (id == NULL_ID && item.issue._id == NULL_ID && item.project._id == NULL_ID)
     {
         DEBUG() << "No issue and no project specified";
         callback( false, NULL_ID, RedmineError::ERR_INCOMPLETE_DATA, QStringList() );
-        RETURN();
+        RETURN( RequestHandle() );
     }
 
     QJsonObject attr;
@@ -380,35 +450,26 @@ SimpleRedmineClient::sendTimeEntry( TimeEntry item, SuccessCb callback, int id,
         if( reply->error() != QNetworkReply::NoError )
         {
             DEBUG() << "Network error:" << reply->errorString();
-            callback( false, NULL_ID, RedmineError::ERR_NETWORK, getErrorList(reply, json) );
+            callback( false, NULL_ID, getNetworkError(reply), getErrorList(reply, json) );
             RETURN();
         }
 
         callback( true, NULL_ID, RedmineError::NO_ERR, QStringList() );
     };
 
-    RedmineClient::sendTimeEntry( json, cb, id, parameters );
+    RequestHandle handle = RedmineClient::sendTimeEntry( json, cb, id, parameters, priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-SimpleRedmineClient::retrieveCustomFields( CustomFieldsCb callback, CustomFieldFilter filter )
+RequestHandle
+SimpleRedmineClient::retrieveCustomFields( CustomFieldsCb callback, CustomFieldFilter filter,
+                                           RequestPriority priority )
 {
     ENTER();
 
-    auto cb = [=]( QNetworkReply* reply, QJsonDocument* json )
+    auto parse = [=]( QJsonDocument* json ) -> CustomFields
     {
-        ENTER();
-
-        // Quit on network error
-        if( reply->error() != QNetworkReply::NoError )
-        {
-            DEBUG() << "Network error:" << reply->errorString();
-            callback( CustomFields(), RedmineError::ERR_NETWORK, getErrorList(reply, json) );
-            RETURN();
-        }
-
         CustomFields customFields;
 
         // Iterate over the document
@@ -498,33 +559,23 @@ SimpleRedmineClient::retrieveCustomFields( CustomFieldsCb callback, CustomFieldF
             }
         }
 
-        callback( customFields, RedmineError::NO_ERR, QStringList() );
-
-        RETURN();
+        return customFields;
     };
 
-    RedmineClient::retrieveCustomFields( cb );
+    RequestHandle handle = decodeRequest( "shared/custom_fields", listDecoder<CustomFields>( parse, callback ), "",
+                                          priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-SimpleRedmineClient::retrieveEnumerations(QString enumeration, EnumerationsCb callback, QString parameters )
+RequestHandle
+SimpleRedmineClient::retrieveEnumerations(QString enumeration, EnumerationsCb callback, QString parameters,
+                                          RequestPriority priority )
 {
     ENTER()(enumeration)(parameters);
 
-    auto cb = [=]( QNetworkReply* reply, QJsonDocument* json )
+    auto parse = [=]( QJsonDocument* json ) -> Enumerations
     {
-        ENTER();
-
-        // Quit on network error
-        if( reply->error() != QNetworkReply::NoError )
-        {
-            DEBUG() << "Network error:" << reply->errorString();
-            callback( Enumerations(), RedmineError::ERR_NETWORK, getErrorList(reply, json) );
-            RETURN();
-        }
-
         Enumerations enumerations;
 
         // Iterate over the document
@@ -548,14 +599,13 @@ SimpleRedmineClient::retrieveEnumerations(QString enumeration, EnumerationsCb ca
             }
         }
 
-        callback( enumerations, RedmineError::NO_ERR, QStringList() );
-
-        RETURN();
+        return enumerations;
     };
 
-    RedmineClient::retrieveEnumerations( enumeration, cb, parameters );
+    RequestHandle handle = decodeRequest( "enumerations/" + enumeration, listDecoder<Enumerations>( parse, callback ),
+                                          parameters, priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
 void
@@ -614,7 +664,23 @@ parseIssue( Issue& issue, QJsonObject* obj )
     RETURN();
   }
 
-void SimpleRedmineClient::retrieveIssue (IssueCb callback, int issueId, QString parameters)
+void
+SimpleRedmineClient::decodeIssue( DecoderBackend decoder, const QByteArray& json, Issue& issue )
+{
+    // Text the fast decoder rejects is left to QJsonDocument
+    Issue decoded = issue;
+    if( decoder == DecoderBackend::Fast && FastJsonDecoder::decodeIssue(json, decoded) )
+    {
+        issue = decoded;
+        return;
+    }
+
+    QJsonObject obj = QJsonDocument::fromJson( json ).object();
+    parseIssue( issue, &obj );
+}
+
+RequestHandle SimpleRedmineClient::retrieveIssue (IssueCb callback, int issueId, QString parameters,
+                                                  RequestPriority priority)
 {
     ENTER()(issueId)(parameters);
 
@@ -626,7 +692,7 @@ void SimpleRedmineClient::retrieveIssue (IssueCb callback, int issueId, QString
         if( reply->error() != QNetworkReply::NoError )
         {
             DEBUG() << "Network error:" << reply->errorString();
-            callback( Issue(), RedmineError::ERR_NETWORK, getErrorList(reply, json) );
+            callback( Issue(), getNetworkError(reply), getErrorList(reply, json) );
             RETURN();
         }
 
@@ -638,88 +704,236 @@ void SimpleRedmineClient::retrieveIssue (IssueCb callback, int issueId, QString
         RETURN();
     };
 
-    RedmineClient::retrieveIssue( cb, issueId, parameters );
+    RequestHandle handle = RedmineClient::retrieveIssue( cb, issueId, parameters, priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void SimpleRedmineClient::retrieveIssues (IssuesCb callback, RedmineOptions options)
+template<typename T>
+RequestHandle
+SimpleRedmineClient::retrievePages (const QString& resource, const QByteArray& arrayKey,
+                                    std::function<void(const QByteArray&, T&)> decode,
+                                    std::function<int(const T&)> id,
+                                    std::function<void(QVector<T>, RedmineError, QStringList)> callback,
+                                    RedmineOptions options)
 {
     struct Data
     {
-        Issues issues;
-        int offset = 0;
-        JsonCb jsonCb;
+        QVector<T> items;
+        QSet<int> seen;
     };
 
-    Data* data = new Data ();
+    // Shared by the callbacks, so that it is also released if the request is cancelled
+    QSharedPointer<Data> data (new Data ());
 
-    data->jsonCb = [=](QNetworkReply *reply, QJsonDocument *json)
+    // Pages may overlap if items were created while fetching, so every item is only reported once
+    auto pageCb = [=](QVector<T> page, int /*offset*/, int /*totalCount*/)
     {
-        Issues& issues = data->issues;
-        int&    offset = data->offset;
-        JsonCb& cb     = data->jsonCb;
-
-        //-- Quit on network error
-        if (reply->error() != QNetworkReply::NoError) {
-            qDebug () << "[SimpleRedmineClient][retrieveIssues] Network error:"
-                      << reply->errorString();
-            callback (Issues (), RedmineError::ERR_NETWORK, getErrorList (reply, json));
-            return;
+        for (const T &item : page) {
+            if (id) {
+                if (data->seen.contains (id (item)))
+                    continue;
+                data->seen.insert (id (item));
+            }
+            data->items.push_back (item);
         }
+    };
 
-        int count = 0;
+    auto finishedCb = [=](int /*count*/, int /*totalCount*/, RedmineError redmineError, QStringList errors)
+    {
+        if (redmineError != RedmineError::NO_ERR)
+            callback (QVector<T> (), redmineError, errors);
+        else
+            callback (data->items, RedmineError::NO_ERR, QStringList ());
+    };
 
-        // Iterate over the document
-        for (const auto& j1 : json->object ())
-        {
-            // Iterate over all issues
-            for (const auto& j2 : j1.toArray ())
-            {
-                Issue issue;
-                QJsonObject obj = j2.toObject ();
-                parseIssue (issue, &obj);
-                issues.push_back (issue);
-                ++count;
-                ++offset;
-            }
-        }
+    return streamPages<T> (resource, arrayKey, decode, pageCb, finishedCb, options);
+}
 
-        if (options.getAllItems && count == _limit)
+template<typename T>
+RequestHandle
+SimpleRedmineClient::streamPages (const QString& resource, const QByteArray& arrayKey,
+                                  std::function<void(const QByteArray&, T&)> decode,
+                                  std::function<void(QVector<T>, int, int)> pageCallback,
+                                  PagesFinishedCb finishedCallback, RedmineOptions options)
+{
+    struct Data
+    {
+        QMap<int, QVector<T>> received; ///< Decoded pages waiting for their predecessors
+        int pageCount = 1;              ///< Number of pages to fetch
+        int nextPage = 1;               ///< Next page to request
+        int nextDelivery = 0;           ///< Next page to hand to the caller
+        int delivered = 0;              ///< Items handed to the caller so far
+        int totalCount = 0;             ///< Total count reported by Redmine
+        bool hasTotalCount = false;     ///< Redmine reported a total count
+        int inFlight = 0;               ///< Requests currently running
+        int pageSize = 0;               ///< Items per page, as far as Redmine grants them
+        bool failed = false;            ///< An error has already been reported
+        RequestHandle handle;           ///< Handle grouping the page requests
+        std::function<void(int)> fetch; ///< Request a single page
+    };
+
+    const int window = options.getAllItems ? qMax (1, options.maxParallelRequests) : 1;
+
+    // The state is owned by the callbacks of the running page requests, so it is released after the
+    // last reply, or when the requests are cancelled and their callbacks dropped
+    QSharedPointer<Data> shared (new Data ());
+    QWeakPointer<Data> weak = shared;
+    shared->pageSize = options.limit > 0 ? options.limit : _limit;
+
+    shared->fetch = [=](int page)
+    {
+        QSharedPointer<Data> data = weak.toStrongRef ();
+        if (!data)
+            return;
+
+        ++data->inFlight;
+
+        // Items are decoded one by one on the thread pool while the page is downloading
+        QSharedPointer<QVector<T>> items (new QVector<T> ());
+        auto element = [decode, items](const QByteArray &json)
         {
-            // In the last run, as many issues as the limit is were found - so there might be more
-            RedmineClient::retrieveIssues (cb,
-                        QString ("%1&offset=%2&limit=%3").arg (options.parameters, offset, _limit));
-        }
-        else
+            T item;
+            decode (json, item);
+            items->push_back (item);
+        };
+
+        auto cb = [=](QNetworkReply *reply, QJsonDocument *json)
         {
-            // No more issues to fetch
-            callback (issues, RedmineError::NO_ERR, QStringList ());
-            delete data;
+            --data->inFlight;
+
+            if (data->failed)
+                return;
+
+            //-- Quit on network error and abandon the remaining pages
+            if (reply->error () != QNetworkReply::NoError) {
+                qDebug () << "[SimpleRedmineClient][streamPages] Network error:" << resource
+                          << reply->errorString ();
+                data->failed = true;
+                finishedCallback (data->delivered, data->totalCount,
+                                  getNetworkError (reply), getErrorList (reply, json));
+                data->handle.cancel ();
+                return;
+            }
+
+            if (page == 0) {
+                // The first page tells how many pages there are; some resources, e.g. versions, are
+                // not paginated and return everything at once
+                data->hasTotalCount = json->object ().contains ("total_count");
+                data->totalCount = json->object ().value ("total_count").toInt ();
+
+                // Redmine caps the limit, by default at 100, and reports the one it applied; without
+                // it, a short first page of a longer list shows the cap. The following pages have to
+                // start from there, so that no items are skipped
+                int limit = json->object ().value ("limit").toInt ();
+                if (limit <= 0 && data->hasTotalCount && !items->isEmpty () && items->size () < data->totalCount)
+                    limit = items->size ();
+                if (limit > 0 && limit < data->pageSize)
+                    data->pageSize = limit;
+
+                if (options.getAllItems && items->size () < data->totalCount)
+                    data->pageCount = qMax (1, (data->totalCount + data->pageSize - 1) / data->pageSize);
+            }
+
+            // Without a total count, keep probing as long as pages come back full
+            if (options.getAllItems && !data->hasTotalCount && items->size () == data->pageSize)
+                data->pageCount = qMax (data->pageCount, page + 2);
+
+            data->received.insert (page, *items);
+
+            // Hand over every page whose predecessors have already been delivered
+            while (data->received.contains (data->nextDelivery)) {
+                QVector<T> ready = data->received.take (data->nextDelivery);
+                data->delivered += ready.size ();
+                pageCallback (ready, data->nextDelivery * data->pageSize, data->totalCount);
+                ++data->nextDelivery;
+            }
+
+            while (data->nextPage < data->pageCount && data->inFlight < window)
+                data->fetch (data->nextPage++);
+
+            if (data->nextDelivery == data->pageCount)
+                finishedCallback (data->delivered, data->totalCount, RedmineError::NO_ERR, QStringList ());
+        };
+
+        QString query = RedmineQuery::page (options.parameters, page * data->pageSize, data->pageSize);
+        RequestHandle request = RedmineClient::streamRequest (resource, arrayKey, element, cb, query, options.priority);
+
+        // A rejected request never calls back, so the caller is told here
+        if (!request.isValid ()) {
+            --data->inFlight;
+            if (!data->failed) {
+                data->failed = true;
+                finishedCallback (data->delivered, data->totalCount, RedmineError::ERR_NETWORK,
+                                  QStringList () << "Request rejected by the client");
+                data->handle.cancel ();
+            }
+            return;
         }
+
+        data->handle.add (request);
     };
 
-    RedmineClient::retrieveIssues (data->jsonCb,
-                                   QString ("%1&offset=%2&limit=%3").arg (options.parameters).arg (0).arg (_limit) );
+    shared->fetch (0);
+
+    return shared->handle;
 }
 
-void
-SimpleRedmineClient::retrieveIssueCategories( IssueCategoriesCb callback, int projectId, QString parameters )
+RequestHandle SimpleRedmineClient::retrieveIssues (IssuesCb callback, RedmineOptions options)
 {
-    ENTER()(projectId)(parameters);
+    DecoderBackend decoder = _decoder;
+    auto decode = [decoder](const QByteArray &json, Issue &issue) { decodeIssue (decoder, json, issue); };
 
-    auto cb = [=]( QNetworkReply* reply, QJsonDocument* json )
-    {
-        ENTER();
+    return retrievePages<Issue> ("issues", "issues", decode, [](const Issue &issue) { return issue.id; },
+                                 callback, options);
+}
 
-        // Quit on network error
-        if( reply->error() != QNetworkReply::NoError )
+RequestHandle
+SimpleRedmineClient::probeIssues (FingerprintCb callback, const RedmineQuery& query, RequestPriority priority)
+{
+    auto cb = [=](QNetworkReply* reply, QJsonDocument* json)
+    {
+        if (reply->error () != QNetworkReply::NoError)
         {
-            DEBUG() << "Network error:" << reply->errorString();
-            callback( IssueCategories(), RedmineError::ERR_NETWORK, getErrorList(reply, json) );
-            RETURN();
+            qDebug () << "[SimpleRedmineClient][probeIssues] Network error:" << reply->errorString ();
+            callback (ListFingerprint (), getNetworkError (reply), getErrorList (reply, json));
+            return;
         }
 
+        ListFingerprint fingerprint;
+        fingerprint.totalCount = json->object ().value ("total_count").toInt ();
+
+        QJsonArray issues = json->object ().value ("issues").toArray ();
+        if (!issues.isEmpty ())
+            fingerprint.newest = issues.first ().toObject ().value ("updated_on").toVariant ().toDateTime ();
+
+        callback (fingerprint, RedmineError::NO_ERR, QStringList ());
+    };
+
+    // Only the most recently updated issue is transferred, the total count comes with it
+    RedmineQuery probe = query;
+    probe.clearSort ().sort ("updated_on", Qt::DescendingOrder);
+
+    return RedmineClient::retrieveIssues (cb, RedmineQuery::page (probe.toString (), 0, 1), priority);
+}
+
+RequestHandle SimpleRedmineClient::streamIssues (IssuesPageCb pageCallback, PagesFinishedCb finishedCallback,
+                                                 RedmineOptions options)
+{
+    DecoderBackend decoder = _decoder;
+    auto decode = [decoder](const QByteArray &json, Issue &issue) { decodeIssue (decoder, json, issue); };
+
+    return streamPages<Issue> ("issues", "issues", decode, pageCallback, finishedCallback, options);
+}
+
+RequestHandle
+SimpleRedmineClient::retrieveIssueCategories( IssueCategoriesCb callback, int projectId, QString parameters,
+                                              RequestPriority priority )
+{
+    ENTER()(projectId)(parameters);
+
+    auto parse = [=]( QJsonDocument* json ) -> IssueCategories
+    {
         IssueCategories issueCategories;
 
         // Iterate over the document
@@ -743,43 +957,34 @@ SimpleRedmineClient::retrieveIssueCategories( IssueCategoriesCb callback, int pr
             }
         }
 
-        callback( issueCategories, RedmineError::NO_ERR, QStringList() );
-
-        RETURN();
+        return issueCategories;
     };
 
-    RedmineClient::retrieveIssueCategories( cb, projectId, parameters );
+    RequestHandle handle = decodeRequest( QString("projects/%1/issue_categories").arg(projectId),
+                                          listDecoder<IssueCategories>( parse, callback ), parameters, priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-SimpleRedmineClient::retrieveIssuePriorities( EnumerationsCb callback, QString parameters )
+RequestHandle
+SimpleRedmineClient::retrieveIssuePriorities( EnumerationsCb callback, QString parameters,
+                                              RequestPriority priority )
 {
     ENTER()(parameters);
 
-    retrieveEnumerations( "issue_priorities", callback, parameters );
+    RequestHandle handle = retrieveEnumerations( "issue_priorities", callback, parameters, priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-SimpleRedmineClient::retrieveIssueStatuses( IssueStatusesCb callback, QString parameters )
+RequestHandle
+SimpleRedmineClient::retrieveIssueStatuses( IssueStatusesCb callback, QString parameters,
+                                            RequestPriority priority )
 {
     ENTER()(parameters);
 
-    auto cb = [=]( QNetworkReply* reply, QJsonDocument* json )
+    auto parse = [=]( QJsonDocument* json ) -> IssueStatuses
     {
-        ENTER();
-
-        // Quit on network error
-        if( reply->error() != QNetworkReply::NoError )
-        {
-            DEBUG() << "Network error:" << reply->errorString();
-            callback( IssueStatuses(), RedmineError::ERR_NETWORK, getErrorList(reply, json) );
-            RETURN();
-        }
-
         IssueStatuses issueStatuses;
 
         // Iterate over the document
@@ -803,64 +1008,47 @@ SimpleRedmineClient::retrieveIssueStatuses( IssueStatusesCb callback, QString pa
             }
         }
 
-        callback( issueStatuses, RedmineError::NO_ERR, QStringList() );
-
-        RETURN();
+        return issueStatuses;
     };
 
-    RedmineClient::retrieveIssueStatuses( cb, parameters );
+    RequestHandle handle = decodeRequest( "issue_statuses", listDecoder<IssueStatuses>( parse, callback ),
+                                          parameters, priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
 void
-SimpleRedmineClient::retrieveMemberships( MembershipsCb callback, int projectId, QString parameters )
+parseMembership( Membership& membership, QJsonObject* obj )
 {
-    ENTER()(projectId)(parameters);
-
-    auto cb = [=]( QNetworkReply* reply, QJsonDocument* json )
-    {
-        ENTER();
-
-        // Quit on network error
-        if( reply->error() != QNetworkReply::NoError )
-        {
-            DEBUG() << "Network error:" << reply->errorString();
-            callback( Memberships(), RedmineError::ERR_NETWORK, getErrorList(reply, json) );
-            RETURN();
-        }
-
-        Memberships memberships;
-
-        // Iterate over the document
-        for( const auto& j1 : json->object() )
-        {
-            // Iterate over all issueStatuss
-            for( const auto& j2 : j1.toArray() )
-            {
-                QJsonObject obj = j2.toObject();
-
-                Membership membership;
+    ENTER();
 
-                // Simple fields
-                membership.id = obj.value("id").toInt();
+    // Simple fields
+    membership.id = obj->value("id").toInt();
 
-                fillItem( membership.project, &obj, "project" );
-                fillItem( membership.user, &obj, "user" );
-                fillItem( membership.group, &obj, "group" );
+    fillItem( membership.project, obj, "project" );
+    fillItem( membership.user, obj, "user" );
+    fillItem( membership.group, obj, "group" );
 
-                memberships.push_back( membership );
-            }
-        }
+    RETURN();
+}
 
-        callback( memberships, RedmineError::NO_ERR, QStringList() );
+RequestHandle
+SimpleRedmineClient::retrieveMemberships( MembershipsCb callback, int projectId, RedmineOptions options )
+{
+    ENTER()(projectId)(options);
 
-        RETURN();
+    auto decode = []( const QByteArray& json, Membership& membership )
+    {
+        QJsonObject obj = QJsonDocument::fromJson( json ).object();
+        parseMembership( membership, &obj );
     };
 
-    RedmineClient::retrieveMemberships( cb, projectId, parameters );
+    RequestHandle handle = retrievePages<Membership>( QString("projects/%1/memberships").arg(projectId),
+                                                      "memberships", decode,
+                                                      []( const Membership& membership ) { return membership.id; },
+                                                      callback, options );
 
-    RETURN();
+    RETURN( handle );
 }
 
 void parseProject (Project& project, QJsonObject* obj)
@@ -899,8 +1087,9 @@ void parseProject (Project& project, QJsonObject* obj)
     fillDefaultFields (project, obj);
   }
 
-void
-SimpleRedmineClient::retrieveProject( ProjectCb callback, int projectId, QString parameters )
+RequestHandle
+SimpleRedmineClient::retrieveProject( ProjectCb callback, int projectId, QString parameters,
+                                      RequestPriority priority )
 {
     ENTER()(projectId)(parameters);
 
@@ -912,7 +1101,7 @@ SimpleRedmineClient::retrieveProject( ProjectCb callback, int projectId, QString
         if( reply->error() != QNetworkReply::NoError )
         {
             DEBUG() << "Network error:" << reply->errorString();
-            callback( Project(), RedmineError::ERR_NETWORK, getErrorList(reply, json) );
+            callback( Project(), getNetworkError(reply), getErrorList(reply, json) );
             RETURN();
         }
 
@@ -924,127 +1113,192 @@ SimpleRedmineClient::retrieveProject( ProjectCb callback, int projectId, QString
         RETURN();
     };
 
-    RedmineClient::retrieveProject( cb, projectId, parameters );
+    RequestHandle handle = RedmineClient::retrieveProject( cb, projectId, parameters, priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-SimpleRedmineClient::retrieveProjects (ProjectsCb callback, const QString &parameters)
+RequestHandle
+SimpleRedmineClient::retrieveProjectDetails( ProjectCb callback, int projectId, RequestPriority priority )
 {
-    auto cb = [=](QNetworkReply* reply, QJsonDocument* json)
+    ENTER()(projectId);
+
+    int generation;
     {
-        if (reply->error() != QNetworkReply::NoError)
+        QMutexLocker locker( &_projectDetailsMutex );
+        auto it = _projectDetails.constFind( projectId );
+        if( it != _projectDetails.constEnd()
+                && it->loadedOn.secsTo( QDateTime::currentDateTimeUtc() ) < PROJECT_DETAILS_TTL )
         {
-            qCritical () << "[SimpleRedmineClient][retrieveProjects] Network error:" << reply->errorString();
-            callback (Projects (), RedmineError::ERR_NETWORK, getErrorList (reply, json));
-            RETURN();
+            Project project = it->project;
+            locker.unlock();
+            callback( project, RedmineError::NO_ERR, QStringList() );
+            RETURN( RequestHandle() );
         }
 
-        Projects projects;
+        generation = _projectDetailsGeneration;
+    }
 
-        // Iterate over the document
-        for (const auto& j1 : json->object ())
+    auto cb = [=]( Project project, RedmineError redmineError, QStringList errors )
+    {
+        if( redmineError == RedmineError::NO_ERR )
         {
-            // Iterate over all projects
-            for (const auto& j2 : j1.toArray ())
-            {
-                Project project;
-                QJsonObject obj = j2.toObject ();
-                parseProject (project, &obj);
-                projects.push_back (project);
-            }
+            QMutexLocker locker( &_projectDetailsMutex );
+            if( generation == _projectDetailsGeneration )
+                _projectDetails.insert( projectId, ProjectDetails { project, QDateTime::currentDateTimeUtc() } );
         }
 
-        callback (projects, RedmineError::NO_ERR, QStringList ());
+        callback( project, redmineError, errors );
     };
 
-    RedmineClient::retrieveProjects (cb, parameters);
+    RequestHandle handle = retrieveProject( cb, projectId, "include=issue_categories,trackers", priority );
+
+    RETURN( handle );
 }
 
 void
-SimpleRedmineClient::retrieveTimeEntries( TimeEntriesCb callback, QString parameters )
+SimpleRedmineClient::invalidateProjectDetails( int projectId )
 {
-    ENTER()(parameters);
+    ENTER()(projectId);
 
-    auto cb = [=]( QNetworkReply* reply, QJsonDocument* json )
+    QMutexLocker locker( &_projectDetailsMutex );
+
+    if( projectId == NULL_ID )
+        _projectDetails.clear();
+    else
+        _projectDetails.remove( projectId );
+
+    ++_projectDetailsGeneration;
+
+    RETURN();
+}
+
+void
+SimpleRedmineClient::decodeProject (DecoderBackend decoder, const QByteArray& json, Project& project)
+{
+    // Text the fast decoder rejects is left to QJsonDocument
+    Project decoded = project;
+    if (decoder == DecoderBackend::Fast && FastJsonDecoder::decodeProject (json, decoded))
     {
-        ENTER();
+        project = decoded;
+        return;
+    }
 
-        // Quit on network error
-        if( reply->error() != QNetworkReply::NoError )
-        {
-            DEBUG() << "Network error:" << reply->errorString();
-            callback( TimeEntries(), RedmineError::ERR_NETWORK, getErrorList(reply, json) );
-            RETURN();
-        }
+    QJsonObject obj = QJsonDocument::fromJson (json).object ();
+    parseProject (project, &obj);
+}
 
-        TimeEntries timeEntries;
+RequestHandle
+SimpleRedmineClient::retrieveProjects (ProjectsCb callback, RedmineOptions options)
+{
+    DecoderBackend decoder = _decoder;
+    auto decode = [decoder](const QByteArray &json, Project &project) { decodeProject (decoder, json, project); };
 
-        // Iterate over the document
-        for( const auto& j1 : json->object() )
-        {
-            // Iterate over all trackers
-            for( const auto& j2 : j1.toArray() )
-            {
-                QJsonObject obj = j2.toObject();
+    return retrievePages<Project> ("projects", "projects", decode, [](const Project &project) { return project._id; },
+                                   callback, options);
+}
 
-                TimeEntry timeEntry;
+void
+SimpleRedmineClient::decodeTimeEntry( DecoderBackend decoder, const QByteArray& json, TimeEntry& timeEntry )
+{
+    // Text the fast decoder rejects is left to QJsonDocument
+    TimeEntry decoded = timeEntry;
+    if( decoder == DecoderBackend::Fast && FastJsonDecoder::decodeTimeEntry(json, decoded) )
+    {
+        timeEntry = decoded;
+        return;
+    }
 
-                // Simple fields
-                timeEntry.comment    = obj.value("comments").toString();
-                timeEntry.hours      = obj.value("hours").toDouble();
+    QJsonObject obj = QJsonDocument::fromJson( json ).object();
 
-                // Dates and times
-                timeEntry.spentOn    = obj.value("spent_on").toVariant().toDate();
+    // Simple fields
+    timeEntry.id         = obj.value("id").toInt();
+    timeEntry.comment    = obj.value("comments").toString();
+    timeEntry.hours      = obj.value("hours").toDouble();
 
-                fillItem( timeEntry.activity, &obj, "activity" );
-                fillItem( timeEntry.issue,    &obj, "issue" );
-                fillItem( timeEntry.project,  &obj, "project" );
+    // Dates and times
+    timeEntry.spentOn    = obj.value("spent_on").toVariant().toDate();
 
-                fillDefaultFields( timeEntry, &obj );
+    fillItem( timeEntry.activity, &obj, "activity" );
+    fillItem( timeEntry.issue,    &obj, "issue" );
+    fillItem( timeEntry.project,  &obj, "project" );
 
-                timeEntries.push_back( timeEntry );
-            }
-        }
+    fillDefaultFields( timeEntry, &obj );
+}
 
-        callback( timeEntries, RedmineError::NO_ERR, QStringList() );
+RequestHandle
+SimpleRedmineClient::retrieveTimeEntries( TimeEntriesCb callback, RedmineOptions options )
+{
+    ENTER()(options);
 
-        RETURN();
+    DecoderBackend decoder = _decoder;
+    auto decode = [decoder]( const QByteArray& json, TimeEntry& timeEntry )
+    {
+        decodeTimeEntry( decoder, json, timeEntry );
+    };
+
+    auto store = [=]( TimeEntries timeEntries, RedmineError redmineError, QStringList errors )
+    {
+        LocalStore* localStore = _store;
+        if( localStore && redmineError == RedmineError::NO_ERR )
+            localStore->storeTimeEntries( timeEntries );
+
+        callback( timeEntries, redmineError, errors );
     };
 
-    RedmineClient::retrieveTimeEntries( cb, parameters );
+    RequestHandle handle = retrievePages<TimeEntry>( "time_entries", "time_entries", decode,
+                                                     []( const TimeEntry& timeEntry ) { return timeEntry.id; },
+                                                     store, options );
 
-    RETURN();
+    RETURN( handle );
 }
 
-void
-SimpleRedmineClient::retrieveTimeEntryActivities( EnumerationsCb callback, QString parameters )
+RequestHandle
+SimpleRedmineClient::streamTimeEntries( TimeEntriesPageCb pageCallback, PagesFinishedCb finishedCallback,
+                                        RedmineOptions options )
 {
-    ENTER()(parameters);
+    ENTER()(options);
+
+    DecoderBackend decoder = _decoder;
+    auto decode = [decoder]( const QByteArray& json, TimeEntry& timeEntry )
+    {
+        decodeTimeEntry( decoder, json, timeEntry );
+    };
 
-    retrieveEnumerations( "time_entry_activities", callback, parameters );
+    auto store = [=]( TimeEntries timeEntries, int offset, int totalCount )
+    {
+        LocalStore* localStore = _store;
+        if( localStore )
+            localStore->storeTimeEntries( timeEntries );
 
-    RETURN();
+        pageCallback( timeEntries, offset, totalCount );
+    };
+
+    RequestHandle handle = streamPages<TimeEntry>( "time_entries", "time_entries", decode, store,
+                                                   finishedCallback, options );
+
+    RETURN( handle );
 }
 
-void
-SimpleRedmineClient::retrieveTrackers( TrackersCb callback, QString parameters )
+RequestHandle
+SimpleRedmineClient::retrieveTimeEntryActivities( EnumerationsCb callback, QString parameters,
+                                                  RequestPriority priority )
 {
     ENTER()(parameters);
 
-    auto cb = [=]( QNetworkReply* reply, QJsonDocument* json )
-    {
-        ENTER();
+    RequestHandle handle = retrieveEnumerations( "time_entry_activities", callback, parameters, priority );
 
-        // Quit on network error
-        if( reply->error() != QNetworkReply::NoError )
-        {
-            DEBUG() << "Network error:" << reply->errorString();
-            callback( Trackers(), RedmineError::ERR_NETWORK, getErrorList(reply, json) );
-            RETURN();
-        }
+    RETURN( handle );
+}
 
+RequestHandle
+SimpleRedmineClient::retrieveTrackers( TrackersCb callback, QString parameters,
+                                       RequestPriority priority )
+{
+    ENTER()(parameters);
+
+    auto parse = [=]( QJsonDocument* json ) -> Trackers
+    {
         Trackers trackers;
 
         // Iterate over the document
@@ -1067,14 +1321,12 @@ SimpleRedmineClient::retrieveTrackers( TrackersCb callback, QString parameters )
             }
         }
 
-        callback( trackers, RedmineError::NO_ERR, QStringList() );
-
-        RETURN();
+        return trackers;
     };
 
-    RedmineClient::retrieveTrackers( cb, parameters );
+    RequestHandle handle = decodeRequest( "trackers", listDecoder<Trackers>( parse, callback ), parameters, priority );
 
-    RETURN();
+    RETURN( handle );
 }
 
 void
@@ -1097,14 +1349,14 @@ parseUser( User& user, QJsonObject* obj )
   RETURN();
 }
 
-void SimpleRedmineClient::retrieveCurrentUser (UserCb callback)
+RequestHandle SimpleRedmineClient::retrieveCurrentUser (UserCb callback, RequestPriority priority)
 {
     auto cb = [=]( QNetworkReply* reply, QJsonDocument* json )
     {
         if (reply->error() != QNetworkReply::NoError)
         {
             qDebug () << "[SimpleRedmineClient][retrieveCurrentUser] Network error:" << reply->errorString ();
-            callback (User (), RedmineError::ERR_NETWORK, getErrorList (reply, json));
+            callback (User (), getNetworkError (reply), getErrorList (reply, json));
             return;
         }
 
@@ -1114,117 +1366,83 @@ void SimpleRedmineClient::retrieveCurrentUser (UserCb callback)
         callback (user, RedmineError::NO_ERR, QStringList ());
     };
 
-    RedmineClient::retrieveCurrentUser (cb);
+    return RedmineClient::retrieveCurrentUser (cb, "", priority);
 }
 
-void
-SimpleRedmineClient::retrieveUsers( UsersCb callback, QString parameters )
+RequestHandle
+SimpleRedmineClient::retrieveUsers( UsersCb callback, RedmineOptions options )
 {
-    ENTER()(parameters);
+    ENTER()(options);
 
-    auto cb = [=]( QNetworkReply* reply, QJsonDocument* json )
+    auto decode = []( const QByteArray& json, User& user )
     {
-        ENTER();
-
-        // Quit on network error
-        if( reply->error() != QNetworkReply::NoError )
-        {
-            DEBUG() << "Network error:" << reply->errorString();
-            callback( Users(), RedmineError::ERR_NETWORK, getErrorList(reply, json) );
-            RETURN();
-        }
-
-        Users users;
-
-        // Iterate over the document
-        for( const auto& j1 : json->object() )
-        {
-            // Iterate over all users
-            for( const auto& j2 : j1.toArray() )
-            {
-                QJsonObject obj = j2.toObject();
-
-                User user;
-                parseUser( user, &obj );
-                users.push_back( user );
-            }
-        }
+        QJsonObject obj = QJsonDocument::fromJson( json ).object();
+        parseUser( user, &obj );
+    };
 
-        callback( users, RedmineError::NO_ERR, QStringList() );
+    auto store = [=]( Users users, RedmineError redmineError, QStringList errors )
+    {
+        LocalStore* localStore = _store;
+        if( localStore && redmineError == RedmineError::NO_ERR )
+            localStore->storeUsers( users );
 
-        RETURN();
+        callback( users, redmineError, errors );
     };
 
-    RedmineClient::retrieveUsers( cb, parameters );
+    RequestHandle handle = retrievePages<User>( "users", "users", decode, []( const User& user ) { return user._id; },
+                                                store, options );
 
-    RETURN();
+    RETURN( handle );
 }
 
 void
-SimpleRedmineClient::retrieveVersions( VersionsCb callback, int projectId, QString parameters )
+parseVersion( Version& version, QJsonObject* obj )
 {
-    ENTER()(projectId)(parameters);
-
-    auto cb = [=]( QNetworkReply* reply, QJsonDocument* json )
-    {
-        ENTER();
-
-        // Quit on network error
-        if( reply->error() != QNetworkReply::NoError )
-        {
-            DEBUG() << "Network error:" << reply->errorString();
-            callback( Versions(), RedmineError::ERR_NETWORK, getErrorList(reply, json) );
-            RETURN();
-        }
-
-        Versions versions;
-
-        // Iterate over the document
-        for( const auto& j1 : json->object() )
-        {
-            // Iterate over all issueStatuss
-            for( const auto& j2 : j1.toArray() )
-            {
-                QJsonObject obj = j2.toObject();
+    ENTER();
 
-                Version version;
+    // Simple fields
+    version.id = obj->value("id").toInt();
+    version.name = obj->value("name").toString();
+    version.description = obj->value("description").toString();
+    version.dueDate = obj->value("due_date").toVariant().toDate();
+
+    QString sharing = obj->value("sharing").toString();
+    if( sharing == "none" )
+        version.sharing = VersionSharing::none;
+    else if( sharing == "descendants" )
+        version.sharing = VersionSharing::descendants;
+    else if( sharing == "hierarchy" )
+        version.sharing = VersionSharing::hierarchy;
+    else if( sharing == "tree" )
+        version.sharing = VersionSharing::tree;
+    else if( sharing == "system" )
+        version.sharing = VersionSharing::system;
+
+    QString status = obj->value("status").toString();
+    if( status == "open" )
+        version.status = VersionStatus::open;
+    else if( status == "locked" )
+        version.status = VersionStatus::locked;
+    else if( status == "closed" )
+        version.status = VersionStatus::closed;
 
-                // Simple fields
-                version.id = obj.value("id").toInt();
-                version.name = obj.value("name").toString();
-                version.description = obj.value("description").toString();
-                version.dueDate = obj.value("due_date").toVariant().toDate();
-
-                QString sharing = obj.value("sharing").toString();
-                if( sharing == "none" )
-                    version.sharing = VersionSharing::none;
-                else if( sharing == "descendants" )
-                    version.sharing = VersionSharing::descendants;
-                else if( sharing == "hierarchy" )
-                    version.sharing = VersionSharing::hierarchy;
-                else if( sharing == "tree" )
-                    version.sharing = VersionSharing::tree;
-                else if( sharing == "system" )
-                    version.sharing = VersionSharing::system;
-
-                QString status = obj.value("status").toString();
-                if( status == "open" )
-                    version.status = VersionStatus::open;
-                else if( status == "locked" )
-                    version.status = VersionStatus::locked;
-                else if( status == "closed" )
-                    version.status = VersionStatus::closed;
-
-                versions.push_back( version );
-            }
-        }
+    RETURN();
+}
 
-        callback( versions, RedmineError::NO_ERR, QStringList() );
+RequestHandle
+SimpleRedmineClient::retrieveVersions( VersionsCb callback, int projectId, RedmineOptions options )
+{
+    ENTER()(projectId)(options);
 
-        RETURN();
+    auto decode = []( const QByteArray& json, Version& version )
+    {
+        QJsonObject obj = QJsonDocument::fromJson( json ).object();
+        parseVersion( version, &obj );
     };
 
-    RedmineClient::retrieveVersions( cb, projectId, parameters );
+    RequestHandle handle = retrievePages<Version>( QString("projects/%1/versions").arg(projectId), "versions",
+                                                   decode, []( const Version& version ) { return version.id; },
+                                                   callback, options );
 
-    RETURN();
+    RETURN( handle );
 }
@@ -4,12 +4,19 @@
 #include "RedmineClient.h"
 #include "SimpleRedmineTypes.h"
 
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
 #include <QObject>
 #include <QString>
 #include <QTime>
 
+#include <atomic>
+
 namespace qtredmine {
 
+class LocalStore;
+
 /**
  * @brief Simple Redmine connection class
  *
@@ -88,6 +95,26 @@ public:
      */
     void reconnect();
 
+    /**
+     * @brief Set the decoder for issues and time entries that are decoded while downloading
+     *
+     * Both decoders yield the same data; \c DecoderBackend::Fast avoids building a QJsonDocument for
+     * every resource.
+     *
+     * @param decoder Decoder backend (default: \c DecoderBackend::Document)
+     */
+    void setDecoder( DecoderBackend decoder );
+
+    /**
+     * @brief Set the local store that keeps retrieved users and time entries
+     *
+     * retrieveUsers(), retrieveTimeEntries() and streamTimeEntries() store what they retrieve before
+     * calling back. The store has to be used on the thread that issues these requests.
+     *
+     * @param store Local store, nullptr to store nothing (default)
+     */
+    void setLocalStore( LocalStore* store );
+
     /// @name Redmine data creators and updaters
     /// @{
 
@@ -98,11 +125,15 @@ public:
      * @param callback Success callback function
      * @param id Issue ID to update; if set to \c NULL_ID, create a new issue
      * @param parameters Additional issue parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void sendIssue( Issue item,
-                    SuccessCb callback = nullptr,
-                    int id = NULL_ID,
-                    QString parameters = "" );
+    RequestHandle sendIssue( Issue item,
+                             SuccessCb callback = nullptr,
+                             int id = NULL_ID,
+                             QString parameters = "",
+                             RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Create or update issue priority in Redmine
@@ -111,11 +142,15 @@ public:
      * @param callback Success callback function
      * @param id Issue priority ID to update; if set to \c NULL_ID, create a new issue priority
      * @param parameters Additional enumeration parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void sendIssuePriority( Enumeration item,
-                            SuccessCb callback = nullptr,
-                            int id = NULL_ID,
-                            QString parameters = "" );
+    RequestHandle sendIssuePriority( Enumeration item,
+                                     SuccessCb callback = nullptr,
+                                     int id = NULL_ID,
+                                     QString parameters = "",
+                                     RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Create or update issue status in Redmine
@@ -124,11 +159,15 @@ public:
      * @param callback Success callback function
      * @param id Issue status ID to update; if set to \c NULL_ID, create a new issue status
      * @param parameters Additional issue status parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void sendIssueStatus( IssueStatus item,
-                          SuccessCb callback = nullptr,
-                          int id = NULL_ID,
-                          QString parameters = "" );
+    RequestHandle sendIssueStatus( IssueStatus item,
+                                   SuccessCb callback = nullptr,
+                                   int id = NULL_ID,
+                                   QString parameters = "",
+                                   RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Create or update project in Redmine
@@ -137,11 +176,15 @@ public:
      * @param callback Success callback function
      * @param id Project ID to update; if set to \c NULL_ID, create a new project
      * @param parameters Additional project parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void sendProject( Project item,
-                      SuccessCb callback = nullptr,
-                      int id = NULL_ID,
-                      QString parameters = "" );
+    RequestHandle sendProject( Project item,
+                               SuccessCb callback = nullptr,
+                               int id = NULL_ID,
+                               QString parameters = "",
+                               RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Create or update time entry in Redmine
@@ -150,11 +193,15 @@ public:
      * @param callback Success callback function
      * @param id Time entry ID to update; if set to \c NULL_ID, create a new time entry
      * @param parameters Additional time entry parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void sendTimeEntry( TimeEntry item,
-                        SuccessCb callback = nullptr,
-                        int id = NULL_ID,
-                        QString parameters = "" );
+    RequestHandle sendTimeEntry( TimeEntry item,
+                                 SuccessCb callback = nullptr,
+                                 int id = NULL_ID,
+                                 QString parameters = "",
+                                 RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Create or update time entry activity in Redmine
@@ -163,11 +210,15 @@ public:
      * @param callback Success callback function
      * @param id Time entry activity ID to update; if set to \c NULL_ID, create a new time entry activity
      * @param parameters Additional enumeration parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void sendTimeEntryActivity( Enumeration item,
-                                SuccessCb callback = nullptr,
-                                int id = NULL_ID,
-                                QString parameters = "" );
+    RequestHandle sendTimeEntryActivity( Enumeration item,
+                                         SuccessCb callback = nullptr,
+                                         int id = NULL_ID,
+                                         QString parameters = "",
+                                         RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Create or update tracker in Redmine
@@ -176,11 +227,15 @@ public:
      * @param callback Success callback function
      * @param id Tracker ID to update; if set to \c NULL_ID, create a new tracker
      * @param parameters Additional tracker parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void sendTracker( Tracker item,
-                      SuccessCb callback = nullptr,
-                      int id = NULL_ID,
-                      QString parameters = "" );
+    RequestHandle sendTracker( Tracker item,
+                               SuccessCb callback = nullptr,
+                               int id = NULL_ID,
+                               QString parameters = "",
+                               RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Create or update version in Redmine
@@ -189,11 +244,15 @@ public:
      * @param callback Success callback function
      * @param id Version ID to update; if set to \c NULL_ID, create a new version
      * @param parameters Additional version parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void sendTracker( Version item,
-                      SuccessCb callback = nullptr,
-                      int id = NULL_ID,
-                      QString parameters = "" );
+    RequestHandle sendTracker( Version item,
+                               SuccessCb callback = nullptr,
+                               int id = NULL_ID,
+                               QString parameters = "",
+                               RequestPriority priority = RequestPriority::Interactive );
 
     /// @}
 
@@ -205,9 +264,13 @@ public:
      *
      * @param callback Callback function with a custom field vector
      * @param filter Additional custom field parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveCustomFields( CustomFieldsCb callback,
-                               CustomFieldFilter filter );
+    RequestHandle retrieveCustomFields( CustomFieldsCb callback,
+                                        CustomFieldFilter filter,
+                                        RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve an issue from Redmine
@@ -215,19 +278,59 @@ public:
      * @param callback Callback function with an issue object
      * @param issueId Issue ID
      * @param parameters Additional issue parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveIssue( IssueCb callback,
-                        int issueId,
-                        QString parameters = "" );
+    RequestHandle retrieveIssue( IssueCb callback,
+                                 int issueId,
+                                 QString parameters = "",
+                                 RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve issues from Redmine
      *
      * @param callback Callback function with an issue vector
      * @param options Additional options
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveIssues( IssuesCb callback,
-                         RedmineOptions options = RedmineOptions() );
+    RequestHandle retrieveIssues( IssuesCb callback,
+                                  RedmineOptions options = RedmineOptions() );
+
+    /**
+     * @brief Retrieve issues from Redmine page by page
+     *
+     * Each page is handed to \c pageCallback as soon as it has been decoded, in offset order.
+     * With \c options.getAllItems set, the first reply's \c total_count determines the remaining
+     * pages, of which up to \c options.maxParallelRequests are fetched at once.
+     *
+     * @param pageCallback Callback function with the issues of one page
+     * @param finishedCallback Callback function called once after the last page or on error
+     * @param options Additional options
+     *
+     * @return Handle to cancel the request
+     */
+    RequestHandle streamIssues( IssuesPageCb pageCallback,
+                                PagesFinishedCb finishedCallback,
+                                RedmineOptions options = RedmineOptions() );
+
+    /**
+     * @brief Probe whether the issues of a query have changed
+     *
+     * Asks for the most recently updated issue only, so the response is a few hundred bytes. If the
+     * fingerprint equals the one of the last refresh, neither an issue was updated nor the number of
+     * issues changed, and the refresh can be skipped.
+     *
+     * @param callback Callback function with the fingerprint of the issue list
+     * @param query Query selecting the issues; its sort order and page size are ignored
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
+     */
+    RequestHandle probeIssues( FingerprintCb callback,
+                               const RedmineQuery& query,
+                               RequestPriority priority = RequestPriority::Background );
 
     /**
      * @brief Retrieve issue categories for a project
@@ -235,28 +338,40 @@ public:
      * @param callback Callback function with a issue category vector
      * @param projectId Project ID
      * @param parameters Additional issue category parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveIssueCategories( IssueCategoriesCb callback,
-                                  int projectId,
-                                  QString parameters = "" );
+    RequestHandle retrieveIssueCategories( IssueCategoriesCb callback,
+                                           int projectId,
+                                           QString parameters = "",
+                                           RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve issue priorities from Redmine
      *
      * @param callback Callback function with an enumeration vector
      * @param parameters Additional enumeration parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveIssuePriorities( EnumerationsCb callback,
-                                  QString parameters = "" );
+    RequestHandle retrieveIssuePriorities( EnumerationsCb callback,
+                                           QString parameters = "",
+                                           RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve issue statuses from Redmine
      *
      * @param callback Callback function with a issue status vector
      * @param parameters Additional issue status parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveIssueStatuses( IssueStatusesCb callback,
-                                QString parameters = "" );
+    RequestHandle retrieveIssueStatuses( IssueStatusesCb callback,
+                                         QString parameters = "",
+                                         RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve memberships for a project
@@ -264,10 +379,12 @@ public:
      * @param callback Callback function with an membership vector
      * @param projectId Project ID to get the memberships of
      * @param options Additional options
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveMemberships( MembershipsCb callback,
-                              int projectId,
-                              QString parameters = "" );
+    RequestHandle retrieveMemberships( MembershipsCb callback,
+                                       int projectId,
+                                       RedmineOptions options = RedmineOptions() );
 
     /**
      * @brief Retrieve an project from Redmine
@@ -275,75 +392,168 @@ public:
      * @param callback Callback function with an project object
      * @param projectId Project ID
      * @param parameters Additional project parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveProject( ProjectCb callback,
-                          int projectId,
-                          QString parameters = "" );
+    RequestHandle retrieveProject( ProjectCb callback,
+                                   int projectId,
+                                   QString parameters = "",
+                                   RequestPriority priority = RequestPriority::Interactive );
+
+    /**
+     * @brief Retrieve a project with its trackers and issue categories
+     *
+     * Project lists leave these out unless they are asked for with an \c include parameter. They are
+     * loaded for a single project on first use, later calls are answered from memory for five
+     * minutes. The memory is cleared when the URL or the authenticator changes.
+     *
+     * @param callback Callback function with the project
+     * @param projectId Project ID
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request; an empty handle if the callback was already called
+     */
+    RequestHandle retrieveProjectDetails( ProjectCb callback,
+                                          int projectId,
+                                          RequestPriority priority = RequestPriority::Interactive );
+
+    /**
+     * @brief Forget projects loaded by retrieveProjectDetails(), e.g. after changing them
+     *
+     * @param projectId Project ID; NULL_ID for all projects
+     */
+    void invalidateProjectDetails( int projectId = NULL_ID );
 
     /**
      * @brief Retrieve projects from Redmine
      *
+     * Trackers and issue categories are only included when asked for, e.g. with
+     * <tt>RedmineQuery().include("trackers")</tt>; see retrieveProjectDetails().
+     *
      * @param callback Callback function with a project vector
-     * @param parameters Additional project parameters
+     * @param options Additional options
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveProjects (ProjectsCb callback, const QString &parameters = "" );
+    RequestHandle retrieveProjects (ProjectsCb callback, RedmineOptions options = RedmineOptions ());
 
     /**
      * @brief Retrieve time entries from Redmine
      *
      * @param callback Callback function with a time entries vector
-     * @param parameters Additional time entry parameters
+     * @param options Additional options
+     *
+     * @return Handle to cancel the request
+     */
+    RequestHandle retrieveTimeEntries( TimeEntriesCb callback,
+                                       RedmineOptions options = RedmineOptions() );
+
+    /**
+     * @brief Retrieve time entries from Redmine page by page
+     *
+     * Works like streamIssues().
+     *
+     * @param pageCallback Callback function with the time entries of one page
+     * @param finishedCallback Callback function called once after the last page or on error
+     * @param options Additional options
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveTimeEntries( TimeEntriesCb callback,
-                              QString parameters = "" );
+    RequestHandle streamTimeEntries( TimeEntriesPageCb pageCallback,
+                                     PagesFinishedCb finishedCallback,
+                                     RedmineOptions options = RedmineOptions() );
 
     /**
      * @brief Retrieve time entry activities from Redmine
      *
      * @param callback Callback function with an enumeration vector
      * @param parameters Additional enumeration parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveTimeEntryActivities( EnumerationsCb callback,
-                                      QString parameters = "" );
+    RequestHandle retrieveTimeEntryActivities( EnumerationsCb callback,
+                                               QString parameters = "",
+                                               RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve trackers from Redmine
      *
      * @param callback Callback function with a tracker vector
      * @param parameters Additional tracker parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveTrackers( TrackersCb callback,
-                           QString parameters = "" );
+    RequestHandle retrieveTrackers( TrackersCb callback,
+                                    QString parameters = "",
+                                    RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve current user from Redmine
      *
      * @param callback Callback function with a user object
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveCurrentUser( UserCb callback );
+    RequestHandle retrieveCurrentUser( UserCb callback,
+                                       RequestPriority priority = RequestPriority::Interactive );
 
     /**
      * @brief Retrieve users from Redmine
      *
      * @param callback Callback function with a user vector
-     * @param parameters Additional user parameters
+     * @param options Additional options
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveUsers( UsersCb callback,
-                        QString parameters = "" );
+    RequestHandle retrieveUsers( UsersCb callback,
+                                 RedmineOptions options = RedmineOptions() );
 
     /**
      * @brief Retrieve versions for a project
      *
      * @param callback Callback function with a version vector
-     * @param projectId Project ID to get the memberships of
-     * @param parameters Additional version parameters
+     * @param projectId Project ID to get the versions of
+     * @param options Additional options
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveVersions( VersionsCb callback,
-                           int projectId,
-                           QString parameters = "" );
+    RequestHandle retrieveVersions( VersionsCb callback,
+                                    int projectId,
+                                    RedmineOptions options = RedmineOptions() );
 
     /// @}
 
+    /**
+     * @brief Decode an issue on any thread, as the list retrievers do
+     *
+     * @param decoder Decoder backend
+     * @param json    JSON text of one issue object
+     * @param issue   Issue to fill
+     */
+    static void decodeIssue( DecoderBackend decoder, const QByteArray& json, Issue& issue );
+
+    /**
+     * @brief Decode a time entry on any thread
+     *
+     * @param decoder   Decoder backend
+     * @param json      JSON text of one time entry object
+     * @param timeEntry Time entry to fill
+     */
+    static void decodeTimeEntry( DecoderBackend decoder, const QByteArray& json, TimeEntry& timeEntry );
+
+    /**
+     * @brief Decode a project on any thread
+     *
+     * @param decoder Decoder backend
+     * @param json    JSON text of one project object
+     * @param project Project to fill
+     */
+    static void decodeProject( DecoderBackend decoder, const QByteArray& json, Project& project );
+
 public slots:
     /**
      * @brief Check whether the connection currently works
@@ -368,12 +578,60 @@ protected:
      * @param enumeration The enumeration to load
      * @param callback    Callback function with an Enumeration vector
      * @param parameters Additional enumeration parameters
+     * @param priority Scheduling priority of the request
+     *
+     * @return Handle to cancel the request
      */
-    void retrieveEnumerations (QString enumeration,
-                               EnumerationsCb callback,
-                               QString parameters = "");
+    RequestHandle retrieveEnumerations (QString enumeration,
+                                        EnumerationsCb callback,
+                                        QString parameters = "",
+                                        RequestPriority priority = RequestPriority::Interactive);
 
 private:
+    /**
+     * @brief Retrieve all items of a list resource at once
+     *
+     * Collects the pages of streamPages() and calls \c callback once with all items.
+     *
+     * @param resource Redmine resource, e.g. \c issues or <tt>projects/1/versions</tt>
+     * @param arrayKey Name of the list in the response, e.g. \c issues
+     * @param decode   Decoder for one item; called on a worker thread
+     * @param id       ID of an item, to drop items that appear on two pages; nullptr to keep all items
+     * @param callback Callback function with the items
+     * @param options  Additional options
+     *
+     * @return Handle to cancel the requests
+     */
+    template<typename T>
+    RequestHandle retrievePages( const QString& resource, const QByteArray& arrayKey,
+                                 std::function<void(const QByteArray&, T&)> decode,
+                                 std::function<int(const T&)> id,
+                                 std::function<void(QVector<T>, RedmineError, QStringList)> callback,
+                                 RedmineOptions options );
+
+    /**
+     * @brief Retrieve a list resource page by page
+     *
+     * Fetches the pages one after the other, or with \c options.getAllItems and
+     * \c options.maxParallelRequests above 1 several at once, and hands each page to
+     * \c pageCallback in offset order as soon as it and its predecessors have been decoded.
+     *
+     * @param resource Redmine resource, e.g. \c issues or <tt>projects/1/versions</tt>
+     * @param arrayKey Name of the list in the response, e.g. \c issues
+     * @param decode   Decoder for one item; called on a worker thread
+     * @param pageCallback Callback function with the items of one page
+     * @param finishedCallback Callback function called once after the last page or on error
+     * @param options  Additional options
+     *
+     * @return Handle to cancel the requests
+     */
+    template<typename T>
+    RequestHandle streamPages( const QString& resource, const QByteArray& arrayKey,
+                               std::function<void(const QByteArray&, T&)> decode,
+                               std::function<void(QVector<T>, int, int)> pageCallback,
+                               PagesFinishedCb finishedCallback,
+                               RedmineOptions options );
+
     /// Maximum number of resources to fetch at once
     int _limit {100};
 
@@ -382,6 +640,28 @@ private:
 
     /// Currently checking the connection
     bool _checkingConnection;
+
+    /// Decoder for streamed resources
+    std::atomic<DecoderBackend> _decoder {DecoderBackend::Document};
+
+    /// Store for retrieved users and time entries
+    std::atomic<LocalStore*> _store {nullptr};
+
+    /// Project loaded by retrieveProjectDetails()
+    struct ProjectDetails
+    {
+        Project   project;  ///< Project with trackers and issue categories
+        QDateTime loadedOn; ///< Time the project was loaded
+    };
+
+    /// Projects with trackers and issue categories by ID
+    QHash<int, ProjectDetails> _projectDetails;
+
+    /// Incremented by invalidateProjectDetails(), so that running requests do not store outdated data
+    int _projectDetailsGeneration {0};
+
+    /// Guards _projectDetails and its generation, which callbacks may access on any thread
+    QMutex _projectDetailsMutex;
 };
 
 } // qtredmine
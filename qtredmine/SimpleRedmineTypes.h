@@ -3,6 +3,7 @@
 
 #include "Logging.h"
 #include "RedmineClient.h"
+#include "RedmineQuery.h"
 
 #include <QDebug>
 #include <QDate>
@@ -28,15 +29,44 @@ enum class RedmineError {
     ERR_TIMEOUT,
 };
 
+/// Decoder for streamed resources
+enum class DecoderBackend {
+    Document, ///< Build a QJsonDocument per resource and read it
+    Fast,     ///< Decode the JSON text straight into the data structure
+};
+
 /// Redmine options
 struct RedmineOptions
 {
     QString parameters;
     bool getAllItems = false;
 
-    RedmineOptions( QString parameters = "", bool getAllItems = false )
+    /// Maximum number of page requests in flight when \c getAllItems is set;
+    /// values above 1 fetch the remaining pages concurrently once \c total_count is known
+    int maxParallelRequests = 1;
+
+    /// Scheduling priority of the page requests
+    RequestPriority priority = RequestPriority::Interactive;
+
+    /// Number of items per page; 0 for the client's default
+    int limit = 0;
+
+    RedmineOptions( QString parameters = "", bool getAllItems = false, int maxParallelRequests = 1,
+                    RequestPriority priority = RequestPriority::Interactive )
         : parameters( parameters ),
-          getAllItems( getAllItems )
+          getAllItems( getAllItems ),
+          maxParallelRequests( maxParallelRequests ),
+          priority( priority )
+    {}
+
+    /// Options filtering on the server by a typed query; the query's page size becomes \c limit
+    RedmineOptions( const RedmineQuery& query, bool getAllItems = false, int maxParallelRequests = 1,
+                    RequestPriority priority = RequestPriority::Interactive )
+        : parameters( query.toString() ),
+          getAllItems( getAllItems ),
+          maxParallelRequests( maxParallelRequests ),
+          priority( priority ),
+          limit( query.limit() )
     {}
 };
 
@@ -49,6 +79,23 @@ struct CustomFieldFilter
     QString format; ///< Format
 };
 
+/// State of a list as reported by a probe, to tell whether a full refresh is needed
+struct ListFingerprint
+{
+    QDateTime newest;          ///< Latest \c updated_on of the list, invalid for an empty list
+    int       totalCount = -1; ///< Number of items in the list, -1 if unknown
+
+    /// Check whether the fingerprint has been probed
+    bool isValid() const { return totalCount >= 0; }
+
+    bool operator==( const ListFingerprint& other ) const
+    {
+        return newest == other.newest && totalCount == other.totalCount;
+    }
+
+    bool operator!=( const ListFingerprint& other ) const { return !( *this == other ); }
+};
+
 /// @name Redmine data structures
 /// @{
 
@@ -207,6 +254,7 @@ struct Project : RedmineResource
 /// Structure representing a time entry
 struct TimeEntry : RedmineResource
 {
+    int     id = NULL_ID; ///< ID
     Item    activity; ///< Activity
     QString comment;  ///< Additional comment
     double  hours = 0;///< Hours spent
@@ -366,6 +414,25 @@ using IssueCb = std::function<void(Issue, RedmineError, QStringList)>;
  */
 using IssuesCb = std::function<void(Issues, RedmineError, QStringList)>;
 
+/**
+ * Typedef for an issues page callback function
+ *
+ * @param Issues Issues of one result page
+ * @param int Offset of the first issue of the page
+ * @param int Total number of issues reported by Redmine
+ */
+using IssuesPageCb = std::function<void(Issues, int, int)>;
+
+/**
+ * Typedef for the completion callback of a paginated retrieval
+ *
+ * @param int Number of items handed to the page callback
+ * @param int Total number of items reported by Redmine
+ * @param RedmineError Redmine error code
+ * @param QStringList Errors that Redmine returned
+ */
+using PagesFinishedCb = std::function<void(int, int, RedmineError, QStringList)>;
+
 /**
  * Typedef for an issue categories callback function
  *
@@ -420,6 +487,15 @@ using ProjectsCb = std::function<void(Projects, RedmineError, QStringList)>;
  */
 using TimeEntriesCb = std::function<void(TimeEntries, RedmineError, QStringList)>;
 
+/**
+ * Typedef for a time entries page callback function
+ *
+ * @param TimeEntries Time entries of one result page
+ * @param int Offset of the first time entry of the page
+ * @param int Total number of time entries reported by Redmine
+ */
+using TimeEntriesPageCb = std::function<void(TimeEntries, int, int)>;
+
 /**
  * Typedef for a trackers callback function
  *
@@ -465,6 +541,15 @@ using VersionCb = std::function<void(Version, RedmineError, QStringList)>;
  */
 using VersionsCb = std::function<void(Versions, RedmineError, QStringList)>;
 
+/**
+ * Typedef for a list probe callback function
+ *
+ * @param ListFingerprint Newest update and item count of the list
+ * @param RedmineError Redmine error code
+ * @param QStringList Errors that Redmine returned
+ */
+using FingerprintCb = std::function<void(ListFingerprint, RedmineError, QStringList)>;
+
 /// @}
 
 } // qtredmine
@@ -550,7 +635,10 @@ inline QDebug
 operator<<( QDebug debug, const qtredmine::RedmineOptions& options )
 {
     QDebugStateSaver saver( debug );
-    debug.nospace() << "[" << options.parameters << ", " << options.getAllItems << "]";
+    debug.nospace() << "[" << options.parameters << ", " << options.getAllItems
+                    << ", " << options.maxParallelRequests
+                    << ", " << static_cast<int>( options.priority )
+                    << ", " << options.limit << "]";
 
     return debug;
 }
@@ -0,0 +1,552 @@
+#include "Snapshot.h"
+#include "StringPool.h"
+
+#include <QtCore/QDebug>
+#include <QtCore/QHash>
+#include <QtCore/QSaveFile>
+#include <QtCore/QVector>
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+using namespace qtredmine;
+
+namespace {
+
+/// Magic number of snapshot files
+const char SNAPSHOT_MAGIC[8] = {'Q', 'R', 'M', 'S', 'N', 'A', 'P', '\0'};
+
+/// Format version of snapshot files
+const quint32 SNAPSHOT_VERSION = 1;
+
+/// Byte order mark, read back differently on a machine of the other byte order
+const quint32 SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+/// Stored value of an invalid time or date
+const qint64 INVALID_TIME = std::numeric_limits<qint64>::min ();
+
+/// Reference into the string table, in UTF-16 code units
+struct StringRef
+{
+    quint32 offset;
+    quint32 length;
+};
+
+/// File header; all sections start at a multiple of 8 bytes
+struct Header
+{
+    char    magic[8];
+    quint32 version;
+    quint32 byteOrder;
+    quint32 issueCount;
+    quint32 projectCount;
+    quint64 issuesOffset;
+    quint64 issueIndexOffset;
+    quint64 projectsOffset;
+    quint64 projectIndexOffset;
+    quint64 stringsOffset;
+    quint64 stringsLength;
+};
+
+/// Issue record
+struct IssueRecord
+{
+    qint32    id;
+    qint32    parentId;
+    qint32    projectId;
+    qint32    statusId;
+    qint32    trackerId;
+    qint32    priorityId;
+    qint32    assignedToId;
+    qint32    authorId;
+    qint32    categoryId;
+    qint32    versionId;
+    StringRef subject;
+    StringRef description;
+    StringRef projectName;
+    StringRef statusName;
+    StringRef trackerName;
+    StringRef priorityName;
+    StringRef assignedToName;
+    StringRef authorName;
+    StringRef categoryName;
+    StringRef versionName;
+    StringRef userName;
+    qint32    userId;
+    qint32    reserved;
+    qint64    createdOn;
+    qint64    updatedOn;
+    qint64    startDate;
+    qint64    dueDate;
+    double    doneRatio;
+    double    estimatedHours;
+};
+
+/// Project record
+struct ProjectRecord
+{
+    qint32    id;
+    qint32    parentId;
+    qint32    isPublic;
+    qint32    userId;
+    StringRef name;
+    StringRef identifier;
+    StringRef description;
+    StringRef parentName;
+    StringRef userName;
+    qint64    createdOn;
+    qint64    updatedOn;
+};
+
+/// Entry of an ID index, sorted by ID
+struct IndexEntry
+{
+    qint32 id;
+    qint32 row;
+};
+
+static_assert (std::is_trivially_copyable<IssueRecord>::value && sizeof (IssueRecord) % 8 == 0,
+               "Issue records must be plain and keep the sections aligned");
+static_assert (std::is_trivially_copyable<ProjectRecord>::value && sizeof (ProjectRecord) % 8 == 0,
+               "Project records must be plain and keep the sections aligned");
+static_assert (sizeof (Header) % 8 == 0 && sizeof (IndexEntry) == 8,
+               "Header and index entries must keep the sections aligned");
+
+/// Builder of the string table; equal strings are stored once
+class StringTable
+{
+public:
+    StringRef add (const QString& string)
+    {
+        auto it = _refs.constFind (string);
+        if (it != _refs.constEnd ())
+            return it.value ();
+
+        StringRef ref {quint32 (_data.size ()), quint32 (string.size ())};
+        _data.append (string);
+        _refs.insert (string, ref);
+        return ref;
+    }
+
+    const QString& data () const { return _data; }
+
+private:
+    QString                   _data;
+    QHash<QString, StringRef> _refs;
+};
+
+qint64 storedTime (const QDateTime& time)
+{
+    return time.isValid () ? time.toMSecsSinceEpoch () : INVALID_TIME;
+}
+
+QDateTime loadedTime (qint64 time)
+{
+    return time == INVALID_TIME ? QDateTime () : QDateTime::fromMSecsSinceEpoch (time, Qt::UTC);
+}
+
+/**
+ * @brief Build the ID index of records
+ *
+ * @param items Resources
+ * @param id    ID of a resource
+ *
+ * @return Index entries sorted by ID
+ */
+template<typename T, typename Id>
+QVector<IndexEntry> buildIndex (const QVector<T>& items, Id id)
+{
+    QVector<IndexEntry> index;
+    index.reserve (items.size ());
+    for (int row = 0; row < items.size (); ++row)
+        index.append (IndexEntry {id (items[row]), row});
+
+    std::sort (index.begin (), index.end (),
+               [](const IndexEntry& a, const IndexEntry& b) { return a.id < b.id; });
+    return index;
+}
+
+template<typename T>
+bool writeSection (QSaveFile& file, const QVector<T>& section)
+{
+    qint64 size = qint64 (section.size ()) * sizeof (T);
+    return file.write (reinterpret_cast<const char*> (section.constData ()), size) == size;
+}
+
+const IssueRecord& issueRecord (const char* record)
+{
+    return *reinterpret_cast<const IssueRecord*> (record);
+}
+
+const ProjectRecord& projectRecord (const char* record)
+{
+    return *reinterpret_cast<const ProjectRecord*> (record);
+}
+
+} // namespace
+
+//-----------------------------------------------------------------
+
+IssueView::IssueView (const Snapshot* snapshot, const char* record)
+    : _snapshot (snapshot)
+    , _record (record)
+{}
+
+int IssueView::id () const           { return issueRecord (_record).id; }
+int IssueView::parentId () const     { return issueRecord (_record).parentId; }
+int IssueView::projectId () const    { return issueRecord (_record).projectId; }
+int IssueView::statusId () const     { return issueRecord (_record).statusId; }
+int IssueView::trackerId () const    { return issueRecord (_record).trackerId; }
+int IssueView::priorityId () const   { return issueRecord (_record).priorityId; }
+int IssueView::assignedToId () const { return issueRecord (_record).assignedToId; }
+
+/// View of a string field of the viewed record
+#define STRING(record, field) \
+    _snapshot->string (record (_record).field.offset, record (_record).field.length)
+
+QStringView IssueView::subject () const        { return STRING (issueRecord, subject); }
+QStringView IssueView::projectName () const    { return STRING (issueRecord, projectName); }
+QStringView IssueView::statusName () const     { return STRING (issueRecord, statusName); }
+QStringView IssueView::trackerName () const    { return STRING (issueRecord, trackerName); }
+QStringView IssueView::priorityName () const   { return STRING (issueRecord, priorityName); }
+QStringView IssueView::assignedToName () const { return STRING (issueRecord, assignedToName); }
+
+QDateTime IssueView::updatedOn () const
+{
+    return loadedTime (issueRecord (_record).updatedOn);
+}
+
+double IssueView::doneRatio () const
+{
+    return issueRecord (_record).doneRatio;
+}
+
+Issue IssueView::toIssue () const
+{
+    const IssueRecord &r = issueRecord (_record);
+    auto item = [this](qint32 id, const StringRef& name)
+    {
+        Item item;
+        item._id = id;
+        QString itemName = _snapshot->string (name.offset, name.length).toString ();
+        item._name = StringPool::itemNames ().intern (itemName);
+        return item;
+    };
+
+    Issue issue;
+    issue.id             = r.id;
+    issue.parentId       = r.parentId;
+    issue.subject        = STRING (issueRecord, subject).toString ();
+    issue.description    = STRING (issueRecord, description).toString ();
+    issue.doneRatio      = r.doneRatio;
+    issue.estimatedHours = r.estimatedHours;
+    issue.project        = item (r.projectId, r.projectName);
+    issue.status         = item (r.statusId, r.statusName);
+    issue.tracker        = item (r.trackerId, r.trackerName);
+    issue.priority       = item (r.priorityId, r.priorityName);
+    issue.assignedTo     = item (r.assignedToId, r.assignedToName);
+    issue.author         = item (r.authorId, r.authorName);
+    issue.category       = item (r.categoryId, r.categoryName);
+    issue.version        = item (r.versionId, r.versionName);
+    issue.user           = item (r.userId, r.userName);
+    issue.createdOn      = loadedTime (r.createdOn);
+    issue.updatedOn      = loadedTime (r.updatedOn);
+    issue.startDate      = QDate::fromJulianDay (r.startDate);
+    issue.dueDate        = QDate::fromJulianDay (r.dueDate);
+
+    return issue;
+}
+
+//-----------------------------------------------------------------
+
+ProjectView::ProjectView (const Snapshot* snapshot, const char* record)
+    : _snapshot (snapshot)
+    , _record (record)
+{}
+
+int ProjectView::id () const        { return projectRecord (_record).id; }
+int ProjectView::parentId () const  { return projectRecord (_record).parentId; }
+bool ProjectView::isPublic () const { return projectRecord (_record).isPublic != 0; }
+
+QStringView ProjectView::name () const       { return STRING (projectRecord, name); }
+QStringView ProjectView::identifier () const { return STRING (projectRecord, identifier); }
+QStringView ProjectView::parentName () const { return STRING (projectRecord, parentName); }
+
+QDateTime ProjectView::updatedOn () const
+{
+    return loadedTime (projectRecord (_record).updatedOn);
+}
+
+Project ProjectView::toProject () const
+{
+    const ProjectRecord &r = projectRecord (_record);
+
+    Project project;
+    project._id           = r.id;
+    project._isPublic     = r.isPublic != 0;
+    project._name         = STRING (projectRecord, name).toString ();
+    project._identifier   = STRING (projectRecord, identifier).toString ();
+    project._description  = STRING (projectRecord, description).toString ();
+    project._parent._id   = r.parentId;
+    project._parent._name = STRING (projectRecord, parentName).toString ();
+    project.user._id      = r.userId;
+    project.user._name    = STRING (projectRecord, userName).toString ();
+    project.createdOn     = loadedTime (r.createdOn);
+    project.updatedOn     = loadedTime (r.updatedOn);
+
+    return project;
+}
+
+#undef STRING
+
+//-----------------------------------------------------------------
+
+Snapshot::Snapshot ()
+{}
+
+Snapshot::~Snapshot ()
+{
+    close ();
+}
+
+bool
+Snapshot::write (const QString& fileName, const Issues& issues, const Projects& projects)
+{
+    StringTable strings;
+
+    QVector<IssueRecord> issueRecords;
+    issueRecords.reserve (issues.size ());
+    for (const Issue &issue : issues)
+    {
+        IssueRecord r {};
+        r.id             = issue.id;
+        r.parentId       = issue.parentId;
+        r.projectId      = issue.project._id;
+        r.statusId       = issue.status._id;
+        r.trackerId      = issue.tracker._id;
+        r.priorityId     = issue.priority._id;
+        r.assignedToId   = issue.assignedTo._id;
+        r.authorId       = issue.author._id;
+        r.categoryId     = issue.category._id;
+        r.versionId      = issue.version._id;
+        r.userId         = issue.user._id;
+        r.subject        = strings.add (issue.subject);
+        r.description    = strings.add (issue.description);
+        r.projectName    = strings.add (issue.project._name);
+        r.statusName     = strings.add (issue.status._name);
+        r.trackerName    = strings.add (issue.tracker._name);
+        r.priorityName   = strings.add (issue.priority._name);
+        r.assignedToName = strings.add (issue.assignedTo._name);
+        r.authorName     = strings.add (issue.author._name);
+        r.categoryName   = strings.add (issue.category._name);
+        r.versionName    = strings.add (issue.version._name);
+        r.userName       = strings.add (issue.user._name);
+        r.createdOn      = storedTime (issue.createdOn);
+        r.updatedOn      = storedTime (issue.updatedOn);
+        r.startDate      = issue.startDate.toJulianDay ();
+        r.dueDate        = issue.dueDate.toJulianDay ();
+        r.doneRatio      = issue.doneRatio;
+        r.estimatedHours = issue.estimatedHours;
+        issueRecords.append (r);
+    }
+
+    QVector<ProjectRecord> projectRecords;
+    projectRecords.reserve (projects.size ());
+    for (const Project &project : projects)
+    {
+        ProjectRecord r {};
+        r.id          = project._id;
+        r.parentId    = project._parent._id;
+        r.isPublic    = project._isPublic ? 1 : 0;
+        r.userId      = project.user._id;
+        r.name        = strings.add (project._name);
+        r.identifier  = strings.add (project._identifier);
+        r.description = strings.add (project._description);
+        r.parentName  = strings.add (project._parent._name);
+        r.userName    = strings.add (project.user._name);
+        r.createdOn   = storedTime (project.createdOn);
+        r.updatedOn   = storedTime (project.updatedOn);
+        projectRecords.append (r);
+    }
+
+    QVector<IndexEntry> issueIndex = buildIndex (issues, [](const Issue& issue) { return issue.id; });
+    QVector<IndexEntry> projectIndex = buildIndex (projects, [](const Project& project) { return project._id; });
+
+    Header header {};
+    std::copy (SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + sizeof (SNAPSHOT_MAGIC), header.magic);
+    header.version            = SNAPSHOT_VERSION;
+    header.byteOrder          = SNAPSHOT_BYTE_ORDER;
+    header.issueCount         = quint32 (issues.size ());
+    header.projectCount       = quint32 (projects.size ());
+    header.issuesOffset       = sizeof (Header);
+    header.issueIndexOffset   = header.issuesOffset + quint64 (issueRecords.size ()) * sizeof (IssueRecord);
+    header.projectsOffset     = header.issueIndexOffset + quint64 (issueIndex.size ()) * sizeof (IndexEntry);
+    header.projectIndexOffset = header.projectsOffset + quint64 (projectRecords.size ()) * sizeof (ProjectRecord);
+    header.stringsOffset      = header.projectIndexOffset + quint64 (projectIndex.size ()) * sizeof (IndexEntry);
+    header.stringsLength      = quint64 (strings.data ().size ());
+
+    QSaveFile file (fileName);
+    if (!file.open (QIODevice::WriteOnly)) {
+        qWarning () << "[Snapshot][write] Cannot write" << fileName << file.errorString ();
+        return false;
+    }
+
+    bool written = file.write (reinterpret_cast<const char*> (&header), sizeof (Header)) == sizeof (Header)
+                   && writeSection (file, issueRecords)
+                   && writeSection (file, issueIndex)
+                   && writeSection (file, projectRecords)
+                   && writeSection (file, projectIndex)
+                   && file.write (reinterpret_cast<const char*> (strings.data ().constData ()),
+                                  qint64 (strings.data ().size ()) * sizeof (QChar))
+                      == qint64 (strings.data ().size ()) * sizeof (QChar);
+
+    if (!written || !file.commit ()) {
+        qWarning () << "[Snapshot][write] Cannot write" << fileName << file.errorString ();
+        return false;
+    }
+
+    return true;
+}
+
+bool
+Snapshot::open (const QString& fileName)
+{
+    close ();
+
+    _file.setFileName (fileName);
+    if (!_file.open (QIODevice::ReadOnly))
+        return false;
+
+    _size = _file.size ();
+    if (_size >= qint64 (sizeof (Header)))
+        _data = _file.map (0, _size);
+
+    if (!_data) {
+        close ();
+        return false;
+    }
+
+    const Header &header = *reinterpret_cast<const Header*> (_data);
+    const quint64 size = quint64 (_size);
+
+    // Offsets are checked against the size first and counts are 32 bit, so none of the sums below can
+    // overflow
+    bool valid = std::equal (SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + sizeof (SNAPSHOT_MAGIC), header.magic)
+            && header.version == SNAPSHOT_VERSION
+            && header.byteOrder == SNAPSHOT_BYTE_ORDER
+            && header.issueCount <= quint32 (std::numeric_limits<int>::max ())
+            && header.projectCount <= quint32 (std::numeric_limits<int>::max ())
+            && header.issuesOffset % 8 == 0 && header.issueIndexOffset % 8 == 0
+            && header.projectsOffset % 8 == 0 && header.projectIndexOffset % 8 == 0
+            && header.stringsOffset % 8 == 0
+            && header.issuesOffset <= size && header.issueIndexOffset <= size
+            && header.projectsOffset <= size && header.projectIndexOffset <= size
+            && header.issuesOffset + quint64 (header.issueCount) * sizeof (IssueRecord) <= size
+            && header.issueIndexOffset + quint64 (header.issueCount) * sizeof (IndexEntry) <= size
+            && header.projectsOffset + quint64 (header.projectCount) * sizeof (ProjectRecord) <= size
+            && header.projectIndexOffset + quint64 (header.projectCount) * sizeof (IndexEntry) <= size
+            && header.stringsOffset <= size
+            && header.stringsLength <= (size - header.stringsOffset) / sizeof (QChar);
+
+    if (!valid) {
+        qWarning () << "[Snapshot][open] Not a valid snapshot:" << fileName;
+        close ();
+        return false;
+    }
+
+    return true;
+}
+
+void
+Snapshot::close ()
+{
+    if (_data)
+        _file.unmap (const_cast<uchar*> (_data));
+
+    _data = nullptr;
+    _size = 0;
+    _file.close ();
+}
+
+bool
+Snapshot::isOpen () const
+{
+    return _data != nullptr;
+}
+
+int
+Snapshot::issueCount () const
+{
+    return _data ? int (reinterpret_cast<const Header*> (_data)->issueCount) : 0;
+}
+
+IssueView
+Snapshot::issue (int row) const
+{
+    const Header &header = *reinterpret_cast<const Header*> (_data);
+    return IssueView (this, reinterpret_cast<const char*> (_data + header.issuesOffset)
+                            + qint64 (row) * sizeof (IssueRecord));
+}
+
+int
+Snapshot::issueRow (int id) const
+{
+    if (!_data)
+        return -1;
+
+    const Header &header = *reinterpret_cast<const Header*> (_data);
+    return findRow (header.issueIndexOffset, int (header.issueCount), id);
+}
+
+int
+Snapshot::projectCount () const
+{
+    return _data ? int (reinterpret_cast<const Header*> (_data)->projectCount) : 0;
+}
+
+ProjectView
+Snapshot::project (int row) const
+{
+    const Header &header = *reinterpret_cast<const Header*> (_data);
+    return ProjectView (this, reinterpret_cast<const char*> (_data + header.projectsOffset)
+                              + qint64 (row) * sizeof (ProjectRecord));
+}
+
+int
+Snapshot::projectRow (int id) const
+{
+    if (!_data)
+        return -1;
+
+    const Header &header = *reinterpret_cast<const Header*> (_data);
+    return findRow (header.projectIndexOffset, int (header.projectCount), id);
+}
+
+int
+Snapshot::findRow (quint64 indexOffset, int count, int id) const
+{
+    const IndexEntry *begin = reinterpret_cast<const IndexEntry*> (_data + indexOffset);
+    const IndexEntry *end = begin + count;
+
+    const IndexEntry *it = std::lower_bound (begin, end, id,
+                                             [](const IndexEntry& entry, int id) { return entry.id < id; });
+
+    // Rows come from the file, so they are checked like everything else
+    if (it == end || it->id != id || it->row < 0 || it->row >= count)
+        return -1;
+
+    return it->row;
+}
+
+QStringView
+Snapshot::string (quint32 offset, quint32 length) const
+{
+    const Header &header = *reinterpret_cast<const Header*> (_data);
+
+    if (quint64 (offset) + length > header.stringsLength)
+        return QStringView ();
+
+    return QStringView (reinterpret_cast<const QChar*> (_data + header.stringsOffset) + offset,
+                        qsizetype (length));
+}
@@ -0,0 +1,194 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "SimpleRedmineTypes.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QString>
+#include <QtCore/QStringView>
+
+namespace qtredmine {
+
+class Snapshot;
+
+//!
+//! @brief Issue in a mapped snapshot
+//!
+//! Strings are views into the mapped file; they, like the view itself, are valid while the snapshot
+//! stays open. toIssue() copies the issue, e.g. to edit it.
+//!
+class IssueView
+{
+public:
+    /// @name Fields of the issue
+    /// @{
+    int id () const;
+    int parentId () const;
+    int projectId () const;
+    int statusId () const;
+    int trackerId () const;
+    int priorityId () const;
+    int assignedToId () const;
+
+    QStringView subject () const;
+    QStringView projectName () const;
+    QStringView statusName () const;
+    QStringView trackerName () const;
+    QStringView priorityName () const;
+    QStringView assignedToName () const;
+
+    QDateTime updatedOn () const;
+    double doneRatio () const;
+    /// @}
+
+    //! @brief Copy the issue out of the snapshot
+    //! @return Issue without custom fields, which snapshots do not hold
+    Issue toIssue () const;
+
+private:
+    friend class Snapshot;
+
+    //! @brief Constructor for a view of a record
+    IssueView (const Snapshot* snapshot, const char* record);
+
+    const Snapshot* _snapshot; ///< Snapshot holding the record
+    const char*     _record;   ///< Record in the mapped file
+};
+
+//!
+//! @brief Project in a mapped snapshot
+//!
+//! Works like IssueView.
+//!
+class ProjectView
+{
+public:
+    /// @name Fields of the project
+    /// @{
+    int id () const;
+    int parentId () const;
+    bool isPublic () const;
+
+    QStringView name () const;
+    QStringView identifier () const;
+    QStringView parentName () const;
+
+    QDateTime updatedOn () const;
+    /// @}
+
+    //! @brief Copy the project out of the snapshot
+    //! @return Project without trackers and issue categories, which snapshots do not hold
+    Project toProject () const;
+
+private:
+    friend class Snapshot;
+
+    //! @brief Constructor for a view of a record
+    ProjectView (const Snapshot* snapshot, const char* record);
+
+    const Snapshot* _snapshot; ///< Snapshot holding the record
+    const char*     _record;   ///< Record in the mapped file
+};
+
+//!
+//! @brief Memory-mapped snapshot of issues and projects
+//!
+//! A snapshot file holds fixed-size records, a table of UTF-16 strings addressed by offset, and an
+//! index per resource sorted by ID. open() maps the file and checks its layout; nothing is decoded, so
+//! the cost of opening does not grow with the number of issues. Rows are read in place through
+//! IssueView and ProjectView.
+//!
+//! Snapshots are written for the byte order and version of the writing client; other files are
+//! rejected by open().
+//!
+class Snapshot
+{
+public:
+    //! @brief Constructor for a closed snapshot
+    Snapshot ();
+
+    //! @brief Destructor; unmaps the file
+    ~Snapshot ();
+
+    Snapshot (const Snapshot&) = delete;
+    Snapshot& operator= (const Snapshot&) = delete;
+
+    //! @brief Write a snapshot file
+    //!
+    //! @param fileName File name; the file is replaced atomically
+    //! @param issues   Issues in the order of IssueView rows
+    //! @param projects Projects in the order of ProjectView rows
+    //!
+    //! @return true on success, false otherwise
+    static bool write (const QString& fileName, const Issues& issues, const Projects& projects);
+
+    //! @brief Map a snapshot file, closing the current one
+    //! @param fileName File name
+    //! @return true if the file is a valid snapshot, false otherwise
+    bool open (const QString& fileName);
+
+    //! @brief Unmap the file; all views become invalid
+    void close ();
+
+    //! @brief Check whether a snapshot is mapped
+    //! @return true if a snapshot is mapped, false otherwise
+    bool isOpen () const;
+
+    //! @brief Get the number of issues
+    int issueCount () const;
+
+    //! @brief Get an issue by row
+    //! @param row Row, from 0 to issueCount() - 1
+    IssueView issue (int row) const;
+
+    //! @brief Find an issue by ID
+    //! @param id Issue ID
+    //! @return Row of the issue, -1 if the snapshot does not hold it
+    int issueRow (int id) const;
+
+    //! @brief Get the number of projects
+    int projectCount () const;
+
+    //! @brief Get a project by row
+    //! @param row Row, from 0 to projectCount() - 1
+    ProjectView project (int row) const;
+
+    //! @brief Find a project by ID
+    //! @param id Project ID
+    //! @return Row of the project, -1 if the snapshot does not hold it
+    int projectRow (int id) const;
+
+private:
+    friend class IssueView;
+    friend class ProjectView;
+
+    //! @brief Get a string of the string table
+    //!
+    //! @param offset Offset in UTF-16 code units
+    //! @param length Length in UTF-16 code units
+    //!
+    //! @return View of the string, empty if it is out of bounds
+    QStringView string (quint32 offset, quint32 length) const;
+
+    //! @brief Find a row in an ID index
+    //!
+    //! @param indexOffset Offset of the index in the file
+    //! @param count       Number of index entries
+    //! @param id          ID to find
+    //!
+    //! @return Row, -1 if the ID is not in the index
+    int findRow (quint64 indexOffset, int count, int id) const;
+
+    /// Mapped file
+    QFile _file;
+
+    /// Start of the mapping, nullptr while closed
+    const uchar* _data {nullptr};
+
+    /// Size of the mapping
+    qint64 _size {0};
+};
+
+} // qtredmine
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,149 @@
+#ifndef SPECULATION_H
+#define SPECULATION_H
+
+#include "RequestHandle.h"
+#include "SimpleRedmineTypes.h"
+
+#include <QtCore/QSharedPointer>
+#include <QtCore/QStringList>
+
+#include <functional>
+
+namespace qtredmine {
+
+//!
+//! @brief Result of a request sent before it is known whether it will be needed
+//!
+//! A speculation is started with callback() as the callback of a request, e.g. while the login is
+//! still being checked. Its result is held back until confirm() is called and then handed to the
+//! first caller of take(), right away or as soon as it arrives. discard() cancels the request and
+//! drops a held result.
+//!
+//! Copies refer to the same speculation. All methods and the request's callback have to be called on
+//! the same thread.
+//!
+template<typename T>
+class Speculation
+{
+public:
+    /// Callback with the result of the request
+    using Callback = std::function<void(T, RedmineError, QStringList)>;
+
+    //! @brief Constructor for a speculation without request, take() always fails
+    Speculation ()
+    {}
+
+    //! @brief Get the callback to pass to the speculative request
+    //!
+    //! Starts a new speculation; copies of the previous one are no longer affected.
+    //!
+    //! @return Callback holding the result
+    Callback callback ()
+    {
+        _state.reset (new State ());
+
+        QWeakPointer<State> weak = _state;
+        return [weak](T result, RedmineError redmineError, QStringList errors)
+        {
+            QSharedPointer<State> state = weak.toStrongRef ();
+            if (!state || state->discarded)
+                return;
+
+            state->result = result;
+            state->redmineError = redmineError;
+            state->errors = errors;
+            state->arrived = true;
+            deliver (state);
+        };
+    }
+
+    //! @brief Set the speculative request, so that discard() can cancel it
+    //! @param request Request started with callback()
+    void setRequest (const RequestHandle& request)
+    {
+        if (_state)
+            _state->request = request;
+    }
+
+    //! @brief Allow the result to be taken
+    void confirm ()
+    {
+        if (!_state || _state->discarded)
+            return;
+
+        _state->confirmed = true;
+        deliver (_state);
+    }
+
+    //! @brief Check whether the speculation has been confirmed
+    //! @return true if confirm() has been called and discard() has not, false otherwise
+    bool isConfirmed () const
+    {
+        return _state && _state->confirmed && !_state->discarded;
+    }
+
+    //! @brief Cancel the request and drop its result
+    void discard ()
+    {
+        if (!_state)
+            return;
+
+        _state->discarded = true;
+        _state->request.cancel ();
+        _state->result = T ();
+        _state->consumer = nullptr;
+    }
+
+    //! @brief Take the result of a confirmed speculation
+    //!
+    //! @param consumer Callback called with the result, right away if it has already arrived
+    //!
+    //! @return true if \c consumer will be called, false if the speculation has not been confirmed,
+    //!         has been discarded or has already been taken, so the request has to be sent again
+    bool take (Callback consumer)
+    {
+        if (!isConfirmed () || _state->taken)
+            return false;
+
+        _state->taken = true;
+        _state->consumer = consumer;
+        deliver (_state);
+        return true;
+    }
+
+private:
+    /// State shared by all copies of a speculation
+    struct State
+    {
+        RequestHandle request;                             ///< Speculative request
+        T             result;                              ///< Result, once arrived
+        RedmineError  redmineError {RedmineError::NO_ERR}; ///< Redmine error of the request
+        QStringList   errors;                              ///< Error messages of the request
+        bool          arrived {false};                     ///< The result has arrived
+        bool          confirmed {false};                   ///< The result may be handed out
+        bool          discarded {false};                   ///< The result is not needed
+        bool          taken {false};                       ///< take() has been called
+        Callback      consumer;                            ///< Callback passed to take()
+    };
+
+    //! @brief Hand the result to the consumer once everything is in place
+    static void deliver (QSharedPointer<State> state)
+    {
+        if (!state->arrived || !state->confirmed || !state->consumer)
+            return;
+
+        // The consumer may start a new speculation or drop the last copy of this one
+        Callback consumer = state->consumer;
+        T result = state->result;
+        state->consumer = nullptr;
+        state->result = T ();
+        consumer (result, state->redmineError, state->errors);
+    }
+
+    /// Shared state, nullptr for a speculation without request
+    QSharedPointer<State> _state;
+};
+
+} // qtredmine
+
+#endif // SPECULATION_H
@@ -0,0 +1,70 @@
+#include "StringPool.h"
+
+using namespace qtredmine;
+
+double
+StringPool::Stats::hitRate () const
+{
+    return lookups > 0 ? double (hits) / lookups : 0;
+}
+
+StringPool&
+StringPool::itemNames ()
+{
+    static StringPool pool;
+    return pool;
+}
+
+QString
+StringPool::intern (const QString& string)
+{
+    // Empty strings share no buffer that could be saved
+    if (string.isEmpty ())
+        return string;
+
+    _lookups.fetchAndAddRelaxed (1);
+
+    {
+        QReadLocker locker (&_lock);
+        auto it = _strings.constFind (string);
+        if (it != _strings.constEnd ()) {
+            _hits.fetchAndAddRelaxed (1);
+            return *it;
+        }
+    }
+
+    // Another thread may have added the string in the meantime
+    QWriteLocker locker (&_lock);
+    auto it = _strings.constFind (string);
+    if (it != _strings.constEnd ()) {
+        _hits.fetchAndAddRelaxed (1);
+        return *it;
+    }
+
+    _strings.insert (string);
+    _bytes += qint64 (string.size ()) * sizeof (QChar);
+    return string;
+}
+
+StringPool::Stats
+StringPool::stats () const
+{
+    Stats stats;
+    {
+        QReadLocker locker (&_lock);
+        stats.size = _strings.size ();
+        stats.bytes = _bytes;
+    }
+    stats.lookups = _lookups.loadAcquire ();
+    stats.hits = _hits.loadAcquire ();
+    return stats;
+}
+
+QDebug
+qtredmine::operator<< (QDebug debug, const StringPool::Stats& stats)
+{
+    QDebugStateSaver saver (debug);
+    debug.nospace () << "StringPool(" << stats.size << " strings, " << stats.bytes << " bytes, "
+                     << stats.hits << "/" << stats.lookups << " hits)";
+    return debug;
+}
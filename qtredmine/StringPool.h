@@ -0,0 +1,76 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QDebug>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+
+namespace qtredmine {
+
+//!
+//! @brief Pool of interned strings
+//!
+//! Interning a string returns the pooled string with equal contents, so all copies share one
+//! implicitly shared buffer and the duplicate is released. The parsers intern the names of items,
+//! which repeat across entities: every issue names its project, status, tracker, priority and so on.
+//!
+//! Strings are never removed from a pool, so only strings out of a limited set should be interned.
+//! A pool can be used from several threads at once.
+//!
+class StringPool
+{
+public:
+    /// Usage statistics
+    struct Stats
+    {
+        int    size    = 0; ///< Number of distinct strings
+        qint64 bytes   = 0; ///< Size of the distinct strings' characters
+        qint64 lookups = 0; ///< Number of interned strings
+        qint64 hits    = 0; ///< Number of interned strings that were already pooled
+
+        //! @brief Get the share of interned strings that were already pooled
+        //! @return Hit rate from 0 to 1, 0 if nothing has been interned
+        double hitRate () const;
+    };
+
+    //! @brief Get the pool of item names used by the parsers
+    //! @return Pool
+    static StringPool& itemNames ();
+
+    //! @brief Intern a string
+    //! @param string String
+    //! @return Pooled string equal to \c string
+    QString intern (const QString& string);
+
+    //! @brief Get usage statistics
+    //! @return Statistics
+    Stats stats () const;
+
+private:
+    /// Guards _strings
+    mutable QReadWriteLock _lock;
+
+    /// Distinct strings
+    QSet<QString> _strings;
+
+    /// Size of the distinct strings' characters
+    qint64 _bytes {0};
+
+    /// Number of interned strings
+    QAtomicInteger<qint64> _lookups {0};
+
+    /// Number of interned strings that were already pooled
+    QAtomicInteger<qint64> _hits {0};
+};
+
+/**
+ * @brief QDebug stream operator for StringPool::Stats
+ * @return QDebug object
+ */
+QDebug operator<< (QDebug debug, const StringPool::Stats& stats);
+
+} // qtredmine
+
+#endif // STRING_POOL_H
@@ -0,0 +1,42 @@
+QT += network concurrent sql
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/FastJsonDecoder.cpp \
+    $$PWD/IssueSyncEngine.cpp \
+    $$PWD/IssueTable.cpp \
+    $$PWD/JsonStreamReader.cpp \
+    $$PWD/KeyAuthenticator.cpp \
+    $$PWD/LocalStore.cpp \
+    $$PWD/Logging.cpp \
+    $$PWD/PasswordAuthenticator.cpp \
+    $$PWD/RedmineClient.cpp \
+    $$PWD/RedmineQuery.cpp \
+    $$PWD/ReferenceData.cpp \
+    $$PWD/RequestHandle.cpp \
+    $$PWD/ResponseCache.cpp \
+    $$PWD/SimpleRedmineClient.cpp \
+    $$PWD/Snapshot.cpp \
+    $$PWD/StringPool.cpp
+
+HEADERS += \
+    $$PWD/Authenticator.h \
+    $$PWD/FastJsonDecoder.h \
+    $$PWD/IssueSyncEngine.h \
+    $$PWD/IssueTable.h \
+    $$PWD/JsonStreamReader.h \
+    $$PWD/KeyAuthenticator.h \
+    $$PWD/LocalStore.h \
+    $$PWD/Logging.h \
+    $$PWD/PasswordAuthenticator.h \
+    $$PWD/RedmineClient.h \
+    $$PWD/RedmineQuery.h \
+    $$PWD/ReferenceData.h \
+    $$PWD/RequestHandle.h \
+    $$PWD/ResponseCache.h \
+    $$PWD/SimpleRedmineClient.h \
+    $$PWD/SimpleRedmineTypes.h \
+    $$PWD/Snapshot.h \
+    $$PWD/Speculation.h \
+    $$PWD/StringPool.h
@@ -0,0 +1,158 @@
+#include "FastJsonDecoder.h"
+#include "SimpleRedmineClient.h"
+
+#include <QtTest/QtTest>
+
+using namespace qtredmine;
+
+//!
+//! @brief Parity test of FastJsonDecoder against the QJsonDocument based parsers
+//!
+//! Every issue is decoded both ways; the fast decoder has to accept it and yield the same issue.
+//!
+class FastJsonDecoderTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void issue_data ();
+    void issue ();
+
+private:
+    static void compareItems (const Item& actual, const Item& expected);
+    static void compareIssues (const Issue& actual, const Issue& expected);
+};
+
+void
+FastJsonDecoderTest::issue_data ()
+{
+    QTest::addColumn<QByteArray> ("json");
+
+    QTest::newRow ("complete") << QByteArray (R"({
+        "id": 4711,
+        "project": {"id": 2, "name": "Website"},
+        "tracker": {"id": 1, "name": "Bug"},
+        "status": {"id": 1, "name": "New"},
+        "priority": {"id": 2, "name": "Normal"},
+        "author": {"id": 5, "name": "Jane Doe"},
+        "assigned_to": {"id": 6, "name": "John Roe"},
+        "category": {"id": 3, "name": "Backend"},
+        "fixed_version": {"id": 7, "name": "1.0"},
+        "parent": {"id": 4700},
+        "subject": "Crash on login",
+        "description": "Steps:\n1. Open the login page\r\n2. Submit",
+        "start_date": "2024-01-02",
+        "due_date": "2024-02-03",
+        "done_ratio": 30,
+        "estimated_hours": 2.5,
+        "custom_fields": [
+            {"id": 1, "name": "Severity", "value": "High"},
+            {"id": 2, "name": "Platforms", "multiple": true, "value": ["Linux", "Windows"]},
+            {"id": 3, "name": "Unset", "value": null}
+        ],
+        "created_on": "2024-01-02T08:00:00Z",
+        "updated_on": "2024-01-31T12:34:56Z"
+    })");
+
+    QTest::newRow ("null dates, missing optional items") << QByteArray (R"({
+        "id": 1,
+        "project": {"id": 2, "name": "Website"},
+        "tracker": {"id": 1, "name": "Bug"},
+        "status": {"id": 1, "name": "New"},
+        "priority": {"id": 2, "name": "Normal"},
+        "author": {"id": 5, "name": "Jane Doe"},
+        "subject": "No dates",
+        "description": "",
+        "start_date": null,
+        "due_date": null,
+        "done_ratio": 0,
+        "estimated_hours": null,
+        "custom_fields": [],
+        "created_on": "2024-01-02T08:00:00Z",
+        "updated_on": "2024-01-02T08:00:00Z"
+    })");
+
+    QTest::newRow ("escaped and non-ASCII strings") << QByteArray (R"({
+        "id": 2,
+        "project": {"id": 2, "name": "Grüne Wiese"},
+        "assigned_to": {"id": 9, "name": "Zoë"},
+        "subject": "Quote \" backslash \\ slash \/ tab \t emoji 😀",
+        "description": "Ümlaut – “typographic” 日本語 \u00e9\ud83d\ude00",
+        "custom_fields": [{"id": 4, "name": "Notiz", "value": "\u00e4\u00f6\u00fc"}]
+    })");
+
+    QTest::newRow ("unknown members") << QByteArray (R"({
+        "id": 3,
+        "subject": "Extra members",
+        "status": {"id": 2, "name": "In Progress", "is_closed": false},
+        "journals": [{"id": 1, "notes": "a \"b\" {c} [d]", "details": []}],
+        "is_private": false,
+        "spent_hours": 1.0,
+        "closed_on": null
+    })");
+}
+
+void
+FastJsonDecoderTest::issue ()
+{
+    QFETCH (QByteArray, json);
+
+    Issue expected;
+    SimpleRedmineClient::decodeIssue (DecoderBackend::Document, json, expected);
+    QVERIFY (expected.id > 0);
+
+    // Called directly, as SimpleRedmineClient would fall back to QJsonDocument on failure
+    Issue actual;
+    QVERIFY (FastJsonDecoder::decodeIssue (json, actual));
+
+    compareIssues (actual, expected);
+}
+
+void
+FastJsonDecoderTest::compareItems (const Item& actual, const Item& expected)
+{
+    QCOMPARE (actual._id, expected._id);
+    QCOMPARE (actual._name, expected._name);
+}
+
+void
+FastJsonDecoderTest::compareIssues (const Issue& actual, const Issue& expected)
+{
+    QCOMPARE (actual.id, expected.id);
+    QCOMPARE (actual.parentId, expected.parentId);
+    QCOMPARE (actual.subject, expected.subject);
+    QCOMPARE (actual.description, expected.description);
+    QCOMPARE (actual.doneRatio, expected.doneRatio);
+    QCOMPARE (actual.estimatedHours, expected.estimatedHours);
+    QCOMPARE (actual.startDate, expected.startDate);
+    QCOMPARE (actual.dueDate, expected.dueDate);
+    QCOMPARE (actual.createdOn, expected.createdOn);
+    QCOMPARE (actual.updatedOn, expected.updatedOn);
+
+    const Item Issue::*items[] = {&Issue::assignedTo, &Issue::author, &Issue::category, &Issue::priority,
+                                  &Issue::project, &Issue::status, &Issue::tracker, &Issue::version};
+    for (const Item Issue::*item : items) {
+        compareItems (actual.*item, expected.*item);
+        if (QTest::currentTestFailed ())
+            return;
+    }
+
+    compareItems (actual.user, expected.user);
+    if (QTest::currentTestFailed ())
+        return;
+
+    QCOMPARE (actual.customFields.size (), expected.customFields.size ());
+    for (int i = 0; i < expected.customFields.size (); ++i) {
+        const CustomField &a = actual.customFields[i];
+        const CustomField &e = expected.customFields[i];
+        QCOMPARE (a.id, e.id);
+        QCOMPARE (a.name, e.name);
+        QCOMPARE (a.values, e.values);
+        QCOMPARE (a.multiple, e.multiple);
+        QCOMPARE (a.type, e.type);
+    }
+}
+
+QTEST_GUILESS_MAIN (FastJsonDecoderTest)
+
+#include "FastJsonDecoderTest.moc"
@@ -0,0 +1,12 @@
+QT += testlib
+QT -= gui
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+TARGET = FastJsonDecoderTest
+
+include(../../qtredmine/qtredmine.pri)
+
+SOURCES += \
+    FastJsonDecoderTest.cpp
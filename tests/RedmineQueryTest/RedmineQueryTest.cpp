@@ -0,0 +1,101 @@
+#include "RedmineQuery.h"
+
+#include <QtCore/QUrl>
+#include <QtCore/QUrlQuery>
+#include <QtTest/QtTest>
+
+using namespace qtredmine;
+
+class RedmineQueryTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void canonicalOrder ();
+    void stableCacheKey ();
+    void statusIdsAreAlternatives ();
+    void statusIdReplacesFilter ();
+    void statusFilterReplacesIds ();
+    void pageKeepsEncodedFilters ();
+    void pageWithoutParameters ();
+};
+
+void
+RedmineQueryTest::canonicalOrder ()
+{
+    RedmineQuery built = RedmineQuery ().tracker (2).project (5).include ("journals").tracker (1)
+            .assignedToMe ().include ("children");
+    RedmineQuery reordered = RedmineQuery ().include ("children").assignedToMe ().tracker (1)
+            .include ("journals").project (5).tracker (2).tracker (1);
+
+    QString expected ("assigned_to_id=me&include=children,journals&project_id=5&tracker_id=1|2");
+    QCOMPARE (built.toString (), expected);
+    QCOMPARE (reordered.toString (), expected);
+}
+
+void
+RedmineQueryTest::stableCacheKey ()
+{
+    QDateTime since (QDate (2024, 1, 31), QTime (12, 0), Qt::UTC);
+    RedmineQuery first = RedmineQuery ().status (RedmineQuery::Any).updatedOn (since).set ("cf_3", "a b");
+    RedmineQuery second = RedmineQuery ().set ("cf_3", "a b").updatedOn (since).status (RedmineQuery::Any);
+
+    // The page size is set per page, so it must not split the cache
+    second.limit (25);
+
+    QCOMPARE (first.toString (), second.toString ());
+
+    // The client keys its caches by the request URL
+    QUrl firstUrl ("https://redmine.example.com/issues.json?" + RedmineQuery::page (first.toString (), 0, 25));
+    QUrl secondUrl ("https://redmine.example.com/issues.json?" + RedmineQuery::page (second.toString (), 0, 25));
+    QCOMPARE (firstUrl.toString (QUrl::FullyEncoded), secondUrl.toString (QUrl::FullyEncoded));
+}
+
+void
+RedmineQueryTest::statusIdsAreAlternatives ()
+{
+    QCOMPARE (RedmineQuery ().status (2).status (1).toString (), QString ("status_id=1|2"));
+}
+
+void
+RedmineQueryTest::statusIdReplacesFilter ()
+{
+    QCOMPARE (RedmineQuery ().status (RedmineQuery::Open).status (1).toString (), QString ("status_id=1"));
+    QCOMPARE (RedmineQuery ().status (RedmineQuery::Any).status (1).status (2).toString (),
+              QString ("status_id=1|2"));
+}
+
+void
+RedmineQueryTest::statusFilterReplacesIds ()
+{
+    QCOMPARE (RedmineQuery ().status (1).status (RedmineQuery::Closed).toString (), QString ("status_id=closed"));
+    QCOMPARE (RedmineQuery ().status (1).status (RedmineQuery::Any).toString (), QString ("status_id=*"));
+}
+
+void
+RedmineQueryTest::pageKeepsEncodedFilters ()
+{
+    QDateTime cursor (QDate (2024, 1, 31), QTime (12, 0), Qt::UTC);
+    RedmineQuery query = RedmineQuery ().updatedOn (cursor).sort ("updated_on", Qt::DescendingOrder);
+
+    QString page = RedmineQuery::page (query.toString (), 50, 25);
+    QCOMPARE (page, QString ("sort=updated_on%3Adesc&updated_on=%3E%3D2024-01-31T12%3A00%3A00Z"
+                             "&offset=50&limit=25"));
+
+    // The server has to see the filter as it was built
+    QUrlQuery sent (QUrl ("https://redmine.example.com/issues.json?" + page));
+    QCOMPARE (sent.queryItemValue ("updated_on", QUrl::FullyDecoded), QString (">=2024-01-31T12:00:00Z"));
+    QCOMPARE (sent.queryItemValue ("sort", QUrl::FullyDecoded), QString ("updated_on:desc"));
+    QCOMPARE (sent.queryItemValue ("offset"), QString ("50"));
+    QCOMPARE (sent.queryItemValue ("limit"), QString ("25"));
+}
+
+void
+RedmineQueryTest::pageWithoutParameters ()
+{
+    QCOMPARE (RedmineQuery::page (QString (), 0, 1), QString ("offset=0&limit=1"));
+}
+
+QTEST_APPLESS_MAIN (RedmineQueryTest)
+
+#include "RedmineQueryTest.moc"
@@ -0,0 +1,16 @@
+QT += testlib
+QT -= gui
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+TARGET = RedmineQueryTest
+
+INCLUDEPATH += ../../qtredmine
+
+SOURCES += \
+    RedmineQueryTest.cpp \
+    ../../qtredmine/RedmineQuery.cpp
+
+HEADERS += \
+    ../../qtredmine/RedmineQuery.h